@@ -0,0 +1,98 @@
+/**
+ * Spritz Cipher Benchmark
+ *
+ * This example code measure the time of SpritzCipher library functions,
+ * To compare the library configurations (e.g. SPRITZ_N values) on a board.
+ *
+ * The circuit:  No external hardware needed.
+ *
+ * This example code is in the public domain.
+ */
+
+/* ArduinoSpritzCipher documentation: <README.md> */
+
+
+/* ArduinoSpritzCipher is configurable in <SpritzCipher.h> with:
+ * SPRITZ_TIMING_SAFE_CRUSH, SPRITZ_WIPE_TRACES, SPRITZ_WIPE_TRACES_PARANOID,
+ * SPRITZ_USE_LIBC, SPRITZ_N, SPRITZ_COOPERATIVE_SHUFFLE.
+ * For detailed information, read the documentation.
+ */
+#include <SpritzCipher.h>
+
+
+/* Key to input */
+const byte testKey[32] =
+{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+  0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+/* Data buffer, Also the output of encryption */
+byte buf[256];
+
+
+void printResult(const char *name, unsigned long t, unsigned int loops)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(t / loops);
+  Serial.println(" us");
+}
+
+void setup() {
+  /* Initialize serial and wait for port to open */
+  Serial.begin(9600);
+  while (!Serial) {
+    ; /* Wait for serial port to connect. Needed for Leonardo only */
+  }
+}
+
+void loop() {
+  const unsigned int loops = 16;
+  byte digest[32]; /* Output buffer */
+  spritz_ctx s_ctx;
+  unsigned long t;
+  unsigned int i;
+
+  Serial.println("[Spritz library benchmark]\n");
+
+  Serial.print("SPRITZ_N=");
+  Serial.print(SPRITZ_N);
+  Serial.print(" sizeof(spritz_ctx)=");
+  Serial.println(sizeof(spritz_ctx));
+
+  /* Key setup */
+  t = micros();
+  for (i = 0; i < loops; i++) {
+    spritz_setup(&s_ctx, testKey, sizeof(testKey));
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+    spritz_step(&s_ctx, 0xFFFF); /* The setup shuffle, Done by spritz_setup() otherwise */
+#endif
+  }
+  printResult("spritz_setup(32 bytes key)", micros() - t, loops);
+
+  /* Encryption */
+  t = micros();
+  for (i = 0; i < loops; i++) {
+    spritz_crypt_inplace(&s_ctx, buf, sizeof(buf));
+  }
+  printResult("spritz_crypt_inplace(256 bytes)", micros() - t, loops);
+
+  /* Hash */
+  t = micros();
+  for (i = 0; i < loops; i++) {
+    spritz_hash_withCtx(&s_ctx, digest, sizeof(digest), buf, sizeof(buf));
+  }
+  printResult("spritz_hash_withCtx(256 bytes, 32 bytes digest)", micros() - t, loops);
+
+  /* MAC */
+  t = micros();
+  for (i = 0; i < loops; i++) {
+    spritz_mac_withCtx(&s_ctx, digest, sizeof(digest), buf, sizeof(buf), testKey, sizeof(testKey));
+  }
+  printResult("spritz_mac_withCtx(256 bytes, 32 bytes digest)", micros() - t, loops);
+
+  delay(5000); /* Wait 5s */
+  Serial.println();
+}
@@ -73,9 +73,8 @@ void loop() {
    * And we like to save memory
    */
   /* Make a 256-bit hash of the entropy in "buf" using one function */
-  spritz_hash_setup(&the_ctx); /* Initialize */
-  spritz_hash_update(&the_ctx, entropy_example, (uint16_t)(sizeof(entropy_example))); /* Add data */
-  spritz_hash_final(&the_ctx, buf, (uint8_t)(sizeof(buf))); /* Output the final hash */
+  spritz_hash_withCtx(&the_ctx, buf, (uint8_t)(sizeof(buf)),
+                      entropy_example, (uint16_t)(sizeof(entropy_example)));
 
   spritz_state_memzero(&the_ctx); /* wipe "the_ctx" data by replacing it with zeros (0x00) */
   spritz_memzero(entropy_example, (uint16_t)(sizeof(entropy_example))); /* wipe "entropy" data by replacing it with zeros (0x00) */
@@ -0,0 +1,159 @@
+/**
+ * Spritz Cipher Cooperative Shuffle Test
+ *
+ * This example code test SpritzCipher library spritz_step():
+ * Doing the setup shuffle step by step (in chunks) must give the same output
+ * as the blocking setup, Including when entropy is added in the middle.
+ * Key 'ABC' stream test vectors are from Spritz paper "RS14.pdf" Page 30:
+ * <https://people.csail.mit.edu/rivest/pubs/RS14.pdf>
+ *
+ * Define SPRITZ_COOPERATIVE_SHUFFLE in <SpritzCipher.h> to test spritz_step().
+ *
+ * The circuit:  No external hardware needed.
+ *
+ * This example code is in the public domain.
+ */
+
+/* ArduinoSpritzCipher documentation: <README.md> */
+
+
+/* ArduinoSpritzCipher is configurable in <SpritzCipher.h> with:
+ * SPRITZ_TIMING_SAFE_CRUSH, SPRITZ_WIPE_TRACES, SPRITZ_WIPE_TRACES_PARANOID,
+ * SPRITZ_USE_LIBC, SPRITZ_COOPERATIVE_SHUFFLE.
+ * For detailed information, read the documentation.
+ */
+#include <SpritzCipher.h>
+
+
+/* Key and entropy to input */
+const byte testKey[3] = { 'A', 'B', 'C' };
+const byte testEntropy1[4] = { 's', 'p', 'a', 'm' };
+const byte testEntropy2[7] = { 'a', 'r', 'c', 'f', 'o', 'u', 'r' };
+
+#if SPRITZ_N == 256U /* Spritz paper "RS14.pdf" Page 30 */
+/* Key 'ABC' stream test vectors */
+const byte testVector[32] =
+{ 0x77, 0x9a, 0x8e, 0x01, 0xf9, 0xe9, 0xcb, 0xc0,
+  0x7f, 0xb9, 0x6b, 0x7e, 0xc1, 0x93, 0x6e, 0x24,
+  0x2e, 0x54, 0xf1, 0x8b, 0x6c, 0x3c, 0x76, 0xcf,
+  0x8f, 0xc8, 0x2f, 0x22, 0x2b, 0x20, 0xe4, 0xbb
+};
+#endif
+
+/* Steps in each spritz_step() call (0 must do nothing) */
+const unsigned int testChunks[4] = { 0, 1, 100, 1000 };
+
+
+/* Setup with the key, If `useStep`: Do the setup shuffle in chunks of `chunk` steps.
+ * If `entropy` is not NULL: Add it after the first chunk and after
+ * the setup shuffle (then spritz_step() must do nothing), Then output.
+ */
+void setupInChunks(byte *buf, byte useStep, unsigned int chunk, const byte *entropy, byte entropyLen)
+{
+  spritz_ctx ctx;
+  byte i;
+
+  spritz_setup(&ctx, testKey, sizeof(testKey));
+  if (!useStep) { /* The blocking path: spritz_setup() and the first output do the shuffles */
+    if (entropy) {
+      spritz_add_entropy(&ctx, entropy, entropyLen);
+      spritz_add_entropy(&ctx, entropy, entropyLen);
+    }
+  }
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+  else {
+    spritz_step(&ctx, (uint16_t)chunk);
+    if (entropy) {
+      spritz_add_entropy(&ctx, entropy, entropyLen);
+    }
+    if (chunk) {
+      while (!spritz_step(&ctx, (uint16_t)chunk)) {
+        ; /* A real-time loop can do other work between the steps */
+      }
+    }
+    if (entropy) {
+      spritz_add_entropy(&ctx, entropy, entropyLen);
+      spritz_step(&ctx, (uint16_t)chunk);
+    }
+    if (chunk && !spritz_is_ready(&ctx)) {
+      buf[0] = (byte)~buf[0]; /* Make the check fail */
+      return;
+    }
+  }
+#else
+  (void)chunk;
+#endif
+
+  for (i = 0; i < 32; i++) {
+    buf[i] = spritz_random8(&ctx);
+  }
+}
+
+void testFunc(const byte *entropy, byte entropyLen)
+{
+  byte expected[32], buf[32];
+  byte failed = 0;
+  unsigned int i;
+
+  setupInChunks(expected, 0, 0, entropy, entropyLen);
+#if SPRITZ_N == 256U
+  if (!entropy && spritz_compare(expected, testVector, sizeof(expected))) {
+    failed = 1;
+  }
+#endif
+
+  for (i = 0; i < sizeof(testChunks) / sizeof(testChunks[0]); i++) {
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+    setupInChunks(buf, 1, testChunks[i], entropy, entropyLen);
+#else
+    setupInChunks(buf, 0, testChunks[i], entropy, entropyLen);
+#endif
+    if (spritz_compare(buf, expected, sizeof(buf))) {
+      failed = 1;
+    }
+  }
+
+  for (i = 0; i < sizeof(buf); i++) {
+    if (buf[i] < 0x10) { /* To print "0F" not "F" */
+      Serial.write('0');
+    }
+    Serial.print(buf[i], HEX);
+  }
+
+  /* Check the output */
+  if (failed) {
+    /* If the output is wrong "Alert" */
+    digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
+    Serial.println("\n** WARNING: Output != Test_Vector **");
+  }
+  Serial.println();
+}
+
+void setup() {
+  /* Initialize serial and wait for port to open */
+  Serial.begin(9600);
+  while (!Serial) {
+    ; /* Wait for serial port to connect. Needed for Leonardo only */
+  }
+
+  /* initialize digital pin LED_BUILTIN (Most boards have this LED connected to digital pin 13) as an output */
+  pinMode(LED_BUILTIN, OUTPUT);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void loop() {
+  Serial.println("[Spritz spritz_step() test]\n");
+#ifndef SPRITZ_COOPERATIVE_SHUFFLE
+  Serial.println("SPRITZ_COOPERATIVE_SHUFFLE is not defined, spritz_step() is not tested.");
+#endif
+
+  /* Key: ABC */
+  testFunc(0, 0);
+  /* Key: ABC, Then entropy: spam */
+  testFunc(testEntropy1, sizeof(testEntropy1));
+  /* Key: ABC, Then entropy: arcfour */
+  testFunc(testEntropy2, sizeof(testEntropy2));
+
+  delay(5000); /* Wait 5s */
+  Serial.println();
+}
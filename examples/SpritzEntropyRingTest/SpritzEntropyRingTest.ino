@@ -0,0 +1,138 @@
+/**
+ * Spritz Cipher Entropy Ring Test
+ *
+ * This example code test SpritzCipher library entropy ring:
+ * spritz_entropy_ring_push() and spritz_entropy_ring_drain() must give
+ * the same spritz state as spritz_add_entropy() with the same bytes,
+ * Including when the ring is full and when its indexes wrap around.
+ *
+ * The circuit:  No external hardware needed.
+ *
+ * This example code is in the public domain.
+ */
+
+/* ArduinoSpritzCipher documentation: <README.md> */
+
+
+/* ArduinoSpritzCipher is configurable in <SpritzCipher.h> with:
+ * SPRITZ_TIMING_SAFE_CRUSH, SPRITZ_WIPE_TRACES, SPRITZ_WIPE_TRACES_PARANOID,
+ * SPRITZ_USE_LIBC, SPRITZ_ENTROPY_RING_SIZE.
+ * For detailed information, read the documentation.
+ */
+#include <SpritzCipher.h>
+
+
+/* Key to input */
+const byte testKey[3] = { 'A', 'B', 'C' };
+
+/* Bytes pushed each round, More than the ring size to fill it */
+#define PUSH_LEN (SPRITZ_ENTROPY_RING_SIZE + 8U)
+/* Rounds, The even rounds fill the ring (SPRITZ_ENTROPY_RING_SIZE bytes accepted),
+ * Enough of them to accept more than 256 bytes (`head` and `tail` wrap around)
+ */
+#define ROUNDS ((256U / SPRITZ_ENTROPY_RING_SIZE) * 2U + 2U)
+
+
+/* Return non-zero value if the spritz states are NOT equal */
+byte compareState(spritz_ctx *ctx_a, spritz_ctx *ctx_b)
+{
+  return spritz_compare(ctx_a->s, ctx_b->s, SPRITZ_N)
+         | (ctx_a->i ^ ctx_b->i) | (ctx_a->j ^ ctx_b->j) | (ctx_a->k ^ ctx_b->k)
+         | (ctx_a->z ^ ctx_b->z) | (ctx_a->a ^ ctx_b->a) | (ctx_a->w ^ ctx_b->w);
+}
+
+void testFunc()
+{
+  spritz_ctx ring_ctx, ref_ctx;
+  spritz_entropy_ring ring;
+  byte accepted[PUSH_LEN]; /* The bytes the ring accepted this round */
+  byte buf_1[32], buf_2[32];
+  byte failed = 0, wrapped = 0;
+  unsigned int round, i, acceptedLen;
+  byte head;
+
+  spritz_setup(&ring_ctx, testKey, sizeof(testKey));
+  spritz_setup(&ref_ctx, testKey, sizeof(testKey));
+  spritz_entropy_ring_init(&ring);
+
+  for (round = 0; round < ROUNDS; round++) {
+    /* Odd rounds do not fill the ring (0 to SPRITZ_ENTROPY_RING_SIZE - 1 bytes) */
+    unsigned int pushLen = (round & 1U) ? ((round >> 1) & (SPRITZ_ENTROPY_RING_SIZE - 1U)) : PUSH_LEN;
+
+    head = ring.head;
+    acceptedLen = 0;
+    for (i = 0; i < pushLen; i++) {
+      byte octet = (byte)(round * PUSH_LEN + i);
+      if (spritz_entropy_ring_push(&ring, octet)) {
+        /* Full: only after SPRITZ_ENTROPY_RING_SIZE bytes */
+        if (acceptedLen != SPRITZ_ENTROPY_RING_SIZE) {
+          failed = 1;
+        }
+      }
+      else {
+        accepted[acceptedLen++] = octet;
+      }
+    }
+    if (pushLen >= SPRITZ_ENTROPY_RING_SIZE && acceptedLen != SPRITZ_ENTROPY_RING_SIZE) {
+      failed = 1;
+    }
+    if (ring.head < head) { /* `head` went past 255 */
+      wrapped = 1;
+    }
+
+    if (spritz_entropy_ring_drain(&ring_ctx, &ring) != acceptedLen) {
+      failed = 1;
+    }
+    spritz_add_entropy(&ref_ctx, accepted, acceptedLen);
+
+    /* The ring is empty after draining it */
+    if (spritz_entropy_ring_drain(&ring_ctx, &ring) != 0) {
+      failed = 1;
+    }
+
+    if (compareState(&ring_ctx, &ref_ctx)) {
+      failed = 1;
+    }
+  }
+  if (!wrapped) { /* The wrap around is not tested */
+    failed = 1;
+  }
+
+  for (i = 0; i < sizeof(buf_1); i++) {
+    buf_1[i] = spritz_random8(&ring_ctx);
+    buf_2[i] = spritz_random8(&ref_ctx);
+    if (buf_1[i] < 0x10) { /* To print "0F" not "F" */
+      Serial.write('0');
+    }
+    Serial.print(buf_1[i], HEX);
+  }
+
+  /* Check the output */
+  if (failed || spritz_compare(buf_1, buf_2, sizeof(buf_1))) {
+    /* If the output is wrong "Alert" */
+    digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
+    Serial.println("\n** WARNING: Ring output != spritz_add_entropy() output **");
+  }
+  Serial.println();
+}
+
+void setup() {
+  /* Initialize serial and wait for port to open */
+  Serial.begin(9600);
+  while (!Serial) {
+    ; /* Wait for serial port to connect. Needed for Leonardo only */
+  }
+
+  /* initialize digital pin LED_BUILTIN (Most boards have this LED connected to digital pin 13) as an output */
+  pinMode(LED_BUILTIN, OUTPUT);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void loop() {
+  Serial.println("[Spritz spritz_entropy_ring_*() test]\n");
+
+  testFunc();
+
+  delay(5000); /* Wait 5s */
+  Serial.println();
+}
@@ -28,6 +28,7 @@ const byte testData1[3] = { 'A', 'B', 'C' };
 const byte testData2[4] = { 's', 'p', 'a', 'm' };
 const byte testData3[7] = { 'a', 'r', 'c', 'f', 'o', 'u', 'r' };
 
+#if SPRITZ_N == 256U /* Spritz paper "RS14.pdf" Page 30 */
 /* Test vectors */
 /* Data 'ABC' hash test vectors */
 const byte testVector1[32] =
@@ -50,6 +51,7 @@ const byte testVector3[32] =
   0xa5, 0xf9, 0xfe, 0x69, 0x44, 0x65, 0x3c, 0xd5,
   0x0e, 0x66, 0xbf, 0x18, 0x9c, 0x63, 0xf6, 0x99
 };
+#endif
 
 
 void testFunc(const byte ExpectedOutput[32], const byte *data, byte dataLen)
@@ -57,6 +59,7 @@ void testFunc(const byte ExpectedOutput[32], const byte *data, byte dataLen)
   byte hashLen = 32; /* 256-bit */
   byte digest[hashLen]; /* Output buffer */
   byte digest_2[hashLen]; /* Output buffer for chunk by chunk API */
+  byte digest_3[hashLen]; /* Output buffer for the caller's context API */
   spritz_ctx hash_ctx; /* the CTX for chunk by chunk API */
   unsigned int i;
 
@@ -75,6 +78,8 @@ void testFunc(const byte ExpectedOutput[32], const byte *data, byte dataLen)
 
   spritz_hash(digest, hashLen, data, dataLen);
 
+  spritz_hash_withCtx(&hash_ctx, digest_3, hashLen, data, dataLen);
+
   for (i = 0; i < sizeof(digest); i++) {
     if (digest[i] < 0x10) { /* To print "0F" not "F" */
       Serial.write('0');
@@ -83,7 +88,8 @@ void testFunc(const byte ExpectedOutput[32], const byte *data, byte dataLen)
   }
 
   /* Check the output */
-  if (spritz_compare(digest, ExpectedOutput, sizeof(digest)) || spritz_compare(digest_2, ExpectedOutput, sizeof(digest_2))) {
+  if (spritz_compare(digest, ExpectedOutput, sizeof(digest)) || spritz_compare(digest_2, ExpectedOutput, sizeof(digest_2))
+      || spritz_compare(digest_3, ExpectedOutput, sizeof(digest_3))) {
     /* If the output is wrong "Alert" */
     digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
     Serial.println("\n** WARNING: Output != Test_Vector **");
@@ -106,12 +112,16 @@ void setup() {
 void loop() {
   Serial.println("[Spritz spritz_hash*() test]\n");
 
+#if SPRITZ_N == 256U
   /* Data: ABC */
   testFunc(testVector1, testData1, sizeof(testData1));
   /* Data: spam */
   testFunc(testVector2, testData2, sizeof(testData2));
   /* Data: arcfour */
   testFunc(testVector3, testData3, sizeof(testData3));
+#else
+  Serial.println("SPRITZ_N is not 256, The test vectors are for N=256 only: Not tested, See the SpritzNTest example.");
+#endif
 
   delay(5000); /* Wait 5s */
   Serial.println();
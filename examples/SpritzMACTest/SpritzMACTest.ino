@@ -25,6 +25,7 @@
 const byte testMsg[3] = { 'A', 'B', 'C' };
 const byte testKey[3] = { 0x00, 0x01, 0x02 };
 
+#if SPRITZ_N == 256U
 /* Test vectors */
 /* MSG='ABC' KEY=0x00,0x01,0x02 MAC test vectors */
 const byte MACtestVector[32] =
@@ -33,16 +34,21 @@ const byte MACtestVector[32] =
   0xb7, 0xc6, 0x4d, 0x4e, 0x99, 0x1e, 0x93, 0x58,
   0xce, 0x81, 0xef, 0xb1, 0x6c, 0xce, 0xc7, 0xed
 };
+#endif
 
 
 void testFunc(const byte ExpectedOutput[32], const byte *msg, byte msgLen, const byte *key, byte keyLen)
 {
   byte macLen = 32; /* 256-bit */
   byte digest[macLen]; /* Output buffer */
+  byte digest_2[macLen]; /* Output buffer for the caller's context API */
+  spritz_ctx mac_ctx; /* the CTX for the caller's context API */
   unsigned int i;
 
   spritz_mac(digest, macLen, msg, msgLen, key, keyLen);
 
+  spritz_mac_withCtx(&mac_ctx, digest_2, macLen, msg, msgLen, key, keyLen);
+
   for (i = 0; i < sizeof(digest); i++) {
     if (digest[i] < 0x10) { /* To print "0F" not "F" */
       Serial.write('0');
@@ -51,7 +57,7 @@ void testFunc(const byte ExpectedOutput[32], const byte *msg, byte msgLen, const
   }
 
   /* Check the output */
-  if (spritz_compare(digest, ExpectedOutput, sizeof(digest))) {
+  if (spritz_compare(digest, ExpectedOutput, sizeof(digest)) || spritz_compare(digest_2, ExpectedOutput, sizeof(digest_2))) {
     /* If the output is wrong "Alert" */
     digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
     Serial.println("\n** WARNING: Output != Test_Vector **");
@@ -74,8 +80,12 @@ void setup() {
 void loop() {
   Serial.println("[Spritz spritz_mac(MSG='ABC' KEY=0x00,0x01,0x02) test]\n");
 
+#if SPRITZ_N == 256U
   /* MSG='ABC' KEY=0x00,0x01,0x02 MAC test vectors */
   testFunc(MACtestVector, testMsg, sizeof(testMsg), testKey, sizeof(testKey));
+#else
+  Serial.println("SPRITZ_N is not 256, The test vectors are for N=256 only: Not tested, See the SpritzNTest example.");
+#endif
 
   delay(5000); /* Wait 5s */
   Serial.println();
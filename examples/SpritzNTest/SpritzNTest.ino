@@ -0,0 +1,177 @@
+/**
+ * Spritz Cipher SPRITZ_N Test
+ *
+ * This example code test SpritzCipher library hash and stream output
+ * with the configured SPRITZ_N (16, 32, 64, 128 or 256).
+ * Test vectors for SPRITZ_N=256 are from Spritz paper "RS14.pdf" Page 30:
+ * <https://people.csail.mit.edu/rivest/pubs/RS14.pdf>
+ * Test vectors for the other SPRITZ_N values are generated by this library.
+ *
+ * The circuit:  No external hardware needed.
+ *
+ * This example code is in the public domain.
+ */
+
+/* ArduinoSpritzCipher documentation: <README.md> */
+
+
+/* ArduinoSpritzCipher is configurable in <SpritzCipher.h> with:
+ * SPRITZ_TIMING_SAFE_CRUSH, SPRITZ_WIPE_TRACES, SPRITZ_WIPE_TRACES_PARANOID,
+ * SPRITZ_USE_LIBC, SPRITZ_N.
+ * For detailed information, read the documentation.
+ */
+#include <SpritzCipher.h>
+
+
+/* Data and key to input */
+const byte testData[3] = { 'A', 'B', 'C' };
+
+/* Test vectors */
+#if SPRITZ_N == 256U /* Spritz paper "RS14.pdf" Page 30 */
+/* Data 'ABC' hash test vectors */
+const byte testVectorHash[32] =
+{ 0x02, 0x8f, 0xa2, 0xb4, 0x8b, 0x93, 0x4a, 0x18,
+  0x62, 0xb8, 0x69, 0x10, 0x51, 0x3a, 0x47, 0x67,
+  0x7c, 0x1c, 0x2d, 0x95, 0xec, 0x3e, 0x75, 0x70,
+  0x78, 0x6f, 0x1c, 0x32, 0x8b, 0xbd, 0x4a, 0x47
+};
+/* Key 'ABC' stream test vectors */
+const byte testVectorStream[32] =
+{ 0x77, 0x9a, 0x8e, 0x01, 0xf9, 0xe9, 0xcb, 0xc0,
+  0x7f, 0xb9, 0x6b, 0x7e, 0xc1, 0x93, 0x6e, 0x24,
+  0x2e, 0x54, 0xf1, 0x8b, 0x6c, 0x3c, 0x76, 0xcf,
+  0x8f, 0xc8, 0x2f, 0x22, 0x2b, 0x20, 0xe4, 0xbb
+};
+#elif SPRITZ_N == 128U /* Generated by this library */
+/* Data 'ABC' hash test vectors */
+const byte testVectorHash[32] =
+{ 0x58, 0x67, 0x19, 0xaf, 0xb1, 0x41, 0x6e, 0xaa,
+  0xa0, 0x6e, 0x52, 0x6d, 0xbe, 0xff, 0xdf, 0x76,
+  0xe2, 0xc7, 0x19, 0x04, 0xa8, 0xd7, 0xd3, 0xe2,
+  0x25, 0xdd, 0x52, 0x6c, 0x04, 0xf8, 0x22, 0x99
+};
+/* Key 'ABC' stream test vectors */
+const byte testVectorStream[32] =
+{ 0x88, 0xcb, 0xab, 0xcb, 0x9d, 0x2b, 0xdf, 0xf4,
+  0x02, 0x32, 0x52, 0x09, 0x7d, 0x63, 0xc2, 0xef,
+  0xf8, 0x33, 0xd9, 0x1a, 0xdc, 0xc3, 0xad, 0x75,
+  0x26, 0xb2, 0x07, 0x01, 0xce, 0xad, 0x01, 0xf7
+};
+#elif SPRITZ_N == 64U /* Generated by this library */
+/* Data 'ABC' hash test vectors */
+const byte testVectorHash[32] =
+{ 0x7e, 0xe0, 0x7a, 0x7e, 0x71, 0x60, 0x03, 0x4c,
+  0xe3, 0xb3, 0x32, 0xb5, 0xa7, 0xa2, 0xa6, 0xbc,
+  0x45, 0x92, 0x4f, 0x15, 0x5e, 0x9a, 0x78, 0xaa,
+  0x37, 0xef, 0xaa, 0xb2, 0xc5, 0x2f, 0x47, 0xf2
+};
+/* Key 'ABC' stream test vectors */
+const byte testVectorStream[32] =
+{ 0x14, 0xa6, 0xd7, 0x9c, 0x00, 0xcd, 0xa6, 0x4e,
+  0xf3, 0xc3, 0x40, 0x95, 0xaa, 0x4e, 0x5f, 0x5b,
+  0xb9, 0xc4, 0xd9, 0x5b, 0x94, 0xb9, 0xb4, 0x0d,
+  0x9c, 0x72, 0x70, 0x6d, 0xa4, 0x72, 0x84, 0x2f
+};
+#elif SPRITZ_N == 32U /* Generated by this library */
+/* Data 'ABC' hash test vectors */
+const byte testVectorHash[32] =
+{ 0xfe, 0x43, 0x1f, 0xfd, 0x0f, 0xae, 0x32, 0x10,
+  0x2f, 0x97, 0x41, 0x69, 0xfe, 0x5e, 0x88, 0xc3,
+  0x84, 0xf4, 0xa9, 0x58, 0xb4, 0x68, 0xb6, 0x1d,
+  0x7c, 0x67, 0x17, 0xc4, 0xab, 0xb4, 0xf3, 0x7e
+};
+/* Key 'ABC' stream test vectors */
+const byte testVectorStream[32] =
+{ 0xda, 0x73, 0x30, 0x04, 0xb8, 0xdf, 0x22, 0xa4,
+  0x63, 0x54, 0x39, 0x78, 0x54, 0x5d, 0xab, 0x67,
+  0xdc, 0x28, 0x03, 0x94, 0x8a, 0x50, 0xb1, 0xf3,
+  0xbb, 0x59, 0xf4, 0x51, 0xc3, 0xba, 0xfa, 0xf6
+};
+#elif SPRITZ_N == 16U /* Generated by this library */
+/* Data 'ABC' hash test vectors */
+const byte testVectorHash[32] =
+{ 0x36, 0x4a, 0xe0, 0x1e, 0x43, 0x28, 0x50, 0x78,
+  0xba, 0x03, 0xf5, 0xe1, 0xe6, 0xbf, 0x04, 0x03,
+  0xa8, 0x7a, 0xad, 0x2c, 0x49, 0x9e, 0x19, 0x60,
+  0xd0, 0x66, 0xbe, 0xa8, 0xcc, 0x40, 0x44, 0xa1
+};
+/* Key 'ABC' stream test vectors */
+const byte testVectorStream[32] =
+{ 0xff, 0x0d, 0x76, 0x25, 0x3c, 0xe3, 0xd1, 0x71,
+  0x5b, 0x5c, 0xd6, 0xe7, 0xce, 0xb8, 0x80, 0x49,
+  0xb5, 0x65, 0x54, 0x44, 0xf3, 0x7a, 0xcf, 0x14,
+  0x27, 0x60, 0x57, 0x75, 0x5f, 0xe0, 0x1c, 0x93
+};
+#endif /* SPRITZ_N */
+
+
+void printHex(const byte *buf, byte len)
+{
+  unsigned int i;
+
+  for (i = 0; i < len; i++) {
+    if (buf[i] < 0x10) { /* To print "0F" not "F" */
+      Serial.write('0');
+    }
+    Serial.print(buf[i], HEX);
+  }
+  Serial.println();
+}
+
+void testFunc()
+{
+  byte buf[32]; /* Output buffer */
+  spritz_ctx s_ctx;
+  unsigned int i;
+
+  Serial.print("SPRITZ_N=");
+  Serial.print(SPRITZ_N);
+  Serial.print(" sizeof(spritz_ctx)=");
+  Serial.println(sizeof(spritz_ctx));
+
+  spritz_hash(buf, sizeof(buf), testData, sizeof(testData));
+  printHex(buf, sizeof(buf));
+
+  /* Check the output */
+  if (spritz_compare(buf, testVectorHash, sizeof(buf))) {
+    /* If the output is wrong "Alert" */
+    digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
+    Serial.println("\n** WARNING: Output != Test_Vector **");
+  }
+
+  spritz_setup(&s_ctx, testData, sizeof(testData));
+  for (i = 0; i < sizeof(buf); i++) {
+    buf[i] = spritz_random8(&s_ctx);
+  }
+  printHex(buf, sizeof(buf));
+
+  /* Check the output */
+  if (spritz_compare(buf, testVectorStream, sizeof(buf))) {
+    /* If the output is wrong "Alert" */
+    digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
+    Serial.println("\n** WARNING: Output != Test_Vector **");
+  }
+  Serial.println();
+}
+
+void setup() {
+  /* Initialize serial and wait for port to open */
+  Serial.begin(9600);
+  while (!Serial) {
+    ; /* Wait for serial port to connect. Needed for Leonardo only */
+  }
+
+  /* initialize digital pin LED_BUILTIN (Most boards have this LED connected to digital pin 13) as an output */
+  pinMode(LED_BUILTIN, OUTPUT);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void loop() {
+  Serial.println("[Spritz SPRITZ_N hash and stream test]\n");
+
+  /* Data: ABC */
+  testFunc();
+
+  delay(5000); /* Wait 5s */
+  Serial.println();
+}
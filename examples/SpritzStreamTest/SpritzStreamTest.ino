@@ -28,6 +28,7 @@ const byte testKey1[3] = { 'A', 'B', 'C' };
 const byte testKey2[4] = { 's', 'p', 'a', 'm' };
 const byte testKey3[7] = { 'a', 'r', 'c', 'f', 'o', 'u', 'r' };
 
+#if SPRITZ_N == 256U /* Spritz paper "RS14.pdf" Page 30 */
 /* Test vectors */
 /* Key 'ABC' stream test vectors */
 const byte testVector1[32] =
@@ -50,6 +51,7 @@ const byte testVector3[32] =
   0x75, 0x4b, 0xf1, 0x03, 0x6f, 0x54, 0xfb, 0x4a,
   0xeb, 0x03, 0x35, 0xd4, 0xa4, 0xe9, 0xa3, 0x6e
 };
+#endif
 
 
 void testFunc(const byte ExpectedOutput[32], const byte *data, byte dataLen)
@@ -98,12 +100,16 @@ void setup() {
 void loop() {
   Serial.println("[Spritz spritz_random8() test]\n");
 
+#if SPRITZ_N == 256U
   /* Key: ABC */
   testFunc(testVector1, testKey1, sizeof(testKey1));
   /* Key: spam */
   testFunc(testVector2, testKey2, sizeof(testKey2));
   /* Key: arcfour */
   testFunc(testVector3, testKey3, sizeof(testKey3));
+#else
+  Serial.println("SPRITZ_N is not 256, The test vectors are for N=256 only: Not tested, See the SpritzNTest example.");
+#endif
 
   delay(5000); /* Wait 5s */
   Serial.println();
@@ -0,0 +1,159 @@
+/**
+ * Spritz Cipher XOF Test
+ *
+ * This example code test SpritzCipher library extendable output (XOF):
+ * spritz_xof_final() and spritz_xof_squeeze() output must be the test vector
+ * (generated by this library, SPRITZ_N=256 only), The same when squeezed
+ * chunk by chunk, And NOT the same as the fixed length digest
+ * or the spritz_setup()/spritz_setup_withIV() keystream of the same input.
+ *
+ * The circuit:  No external hardware needed.
+ *
+ * This example code is in the public domain.
+ */
+
+/* ArduinoSpritzCipher documentation: <README.md> */
+
+
+/* ArduinoSpritzCipher is configurable in <SpritzCipher.h> with:
+ * SPRITZ_TIMING_SAFE_CRUSH, SPRITZ_WIPE_TRACES, SPRITZ_WIPE_TRACES_PARANOID,
+ * SPRITZ_USE_LIBC.
+ * For detailed information, read the documentation.
+ */
+#include <SpritzCipher.h>
+
+
+/* Data and key to input */
+const byte testData[3] = { 'A', 'B', 'C' };
+const byte testMsg[4] = { 's', 'p', 'a', 'm' };
+
+#if SPRITZ_N == 256U /* Generated by this library */
+/* Data 'ABC' hash XOF test vectors */
+const byte testVectorHashXOF[32] =
+{ 0xdb, 0x18, 0xed, 0x38, 0x51, 0x35, 0xa6, 0x88,
+  0x0b, 0x30, 0x45, 0xe2, 0xd5, 0x73, 0xc8, 0x68,
+  0x7b, 0x94, 0xcf, 0x0f, 0x26, 0xc6, 0x44, 0xcd,
+  0x5a, 0x2b, 0x34, 0xef, 0xbe, 0x80, 0x95, 0xd8
+};
+/* Key 'ABC' and message 'spam' MAC XOF test vectors */
+const byte testVectorMACXOF[32] =
+{ 0xd3, 0x6b, 0x9a, 0x86, 0x55, 0x0f, 0xc3, 0x8f,
+  0x1f, 0x1d, 0x98, 0x01, 0xd8, 0x43, 0x3b, 0xe4,
+  0x7c, 0xc5, 0x66, 0x94, 0xb4, 0xa3, 0xbb, 0xd5,
+  0x3d, 0x8e, 0xb6, 0x66, 0x22, 0x94, 0xc1, 0x43
+};
+#endif
+
+
+void printBuf(const byte *buf, byte len)
+{
+  byte i;
+
+  for (i = 0; i < len; i++) {
+    if (buf[i] < 0x10) { /* To print "0F" not "F" */
+      Serial.write('0');
+    }
+    Serial.print(buf[i], HEX);
+  }
+  Serial.println();
+}
+
+/* Check the XOF output, Return non-zero value if it is wrong */
+byte checkXOF(spritz_ctx *ctx, const byte *xof, const byte *xof_chunks,
+              const byte *expected, const byte *digest)
+{
+  byte keystream[32];
+  byte i;
+
+  for (i = 0; i < sizeof(keystream); i++) {
+    keystream[i] = spritz_random8(ctx);
+  }
+
+  return spritz_compare(xof, xof_chunks, 32) /* Must be equal */
+         || (expected && spritz_compare(xof, expected, 32))
+         || !spritz_compare(xof, digest, 32) /* Must NOT be equal */
+         || !spritz_compare(xof, keystream, 32);
+}
+
+void testFunc()
+{
+  spritz_ctx ctx;
+  byte xof[32], xof_chunks[32], digest[32];
+  const byte *expected = 0;
+  byte i, failed;
+
+  /* Hash XOF */
+  spritz_hash_setup(&ctx);
+  spritz_hash_update(&ctx, testData, sizeof(testData));
+  spritz_xof_final(&ctx);
+  spritz_xof_squeeze(&ctx, xof, sizeof(xof));
+
+  spritz_hash_setup(&ctx);
+  spritz_hash_update(&ctx, testData, sizeof(testData));
+  spritz_xof_final(&ctx);
+  /* For easy test: code squeeze a byte each time */
+  for (i = 0; i < sizeof(xof_chunks); i++) {
+    spritz_xof_squeeze(&ctx, xof_chunks + i, 1);
+  }
+
+  spritz_hash(digest, sizeof(digest), testData, sizeof(testData));
+  spritz_setup(&ctx, testData, sizeof(testData));
+#if SPRITZ_N == 256U
+  expected = testVectorHashXOF;
+#endif
+  failed = checkXOF(&ctx, xof, xof_chunks, expected, digest);
+
+  Serial.print("Hash XOF: ");
+  printBuf(xof, sizeof(xof));
+
+  /* MAC XOF */
+  spritz_mac_setup(&ctx, testData, sizeof(testData));
+  spritz_mac_update(&ctx, testMsg, sizeof(testMsg));
+  spritz_xof_final(&ctx);
+  spritz_xof_squeeze(&ctx, xof, sizeof(xof));
+
+  spritz_mac_setup(&ctx, testData, sizeof(testData));
+  spritz_mac_update(&ctx, testMsg, sizeof(testMsg));
+  spritz_xof_final(&ctx);
+  spritz_xof_squeeze(&ctx, xof_chunks, 5);
+  spritz_xof_squeeze(&ctx, xof_chunks + 5, sizeof(xof_chunks) - 5);
+
+  spritz_mac(digest, sizeof(digest), testMsg, sizeof(testMsg), testData, sizeof(testData));
+  spritz_setup_withIV(&ctx, testData, sizeof(testData), testMsg, sizeof(testMsg));
+#if SPRITZ_N == 256U
+  expected = testVectorMACXOF;
+#endif
+  failed |= checkXOF(&ctx, xof, xof_chunks, expected, digest);
+
+  Serial.print("MAC XOF:  ");
+  printBuf(xof, sizeof(xof));
+
+  /* Check the output */
+  if (failed) {
+    /* If the output is wrong "Alert" */
+    digitalWrite(LED_BUILTIN, HIGH); /* Turn pin LED_BUILTIN On (Most boards have this LED connected to digital pin 13) */
+    Serial.println("\n** WARNING: Output != Test_Vector **");
+  }
+  Serial.println();
+}
+
+void setup() {
+  /* Initialize serial and wait for port to open */
+  Serial.begin(9600);
+  while (!Serial) {
+    ; /* Wait for serial port to connect. Needed for Leonardo only */
+  }
+
+  /* initialize digital pin LED_BUILTIN (Most boards have this LED connected to digital pin 13) as an output */
+  pinMode(LED_BUILTIN, OUTPUT);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void loop() {
+  Serial.println("[Spritz spritz_xof_*() test]\n");
+
+  testFunc();
+
+  delay(5000); /* Wait 5s */
+  Serial.println();
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+# SPDX-License-Identifier: ISC
+#
+# Check that a program compiled with another SPRITZ_N than the library
+# fails to link, Also with `--gc-sections` and with LTO.
+# Usage: sh extras/spritz_n_link_test.sh [CC]  (from the library folder, CC default: cc)
+
+CC=${CC:-cc}
+[ -n "$1" ] && CC=$1
+SRC=$(dirname "$0")/../src
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+FAILED=0
+
+cat > "$TMP/main.c" << 'EOF'
+#include <SpritzCipher.h>
+int main(void)
+{
+  spritz_ctx ctx;
+  spritz_setup(&ctx, (const uint8_t *)"ABC", 3);
+  return spritz_random8(&ctx) == 0;
+}
+EOF
+
+# link LIB_N MAIN_N FLAGS: Return zero if the program links
+link() {
+  $CC $3 -I"$SRC" -DSPRITZ_N="$1" -c "$SRC/SpritzCipher.c" -o "$TMP/lib.o" \
+    && $CC $3 -I"$SRC" -DSPRITZ_N="$2" -c "$TMP/main.c" -o "$TMP/main.o" \
+    && $CC $3 "$TMP/main.o" "$TMP/lib.o" -o "$TMP/main" 2> /dev/null
+}
+
+for FLAGS in "-Os" "-Os -ffunction-sections -fdata-sections -Wl,--gc-sections" \
+             "-Os -flto -ffunction-sections -fdata-sections -Wl,--gc-sections"; do
+  for N in 256U 128U 64U 32U 16U; do
+    if ! link $N $N "$FLAGS"; then
+      echo "FAIL: SPRITZ_N=$N does not link [$FLAGS]"
+      FAILED=1
+    fi
+    for M in 256U 16U; do
+      if [ $M != $N ] && link $N $M "$FLAGS"; then
+        echo "FAIL: Library SPRITZ_N=$N and program SPRITZ_N=$M link [$FLAGS]"
+        FAILED=1
+      fi
+    done
+  done
+done
+
+[ $FAILED = 0 ] && echo "OK"
+exit $FAILED
@@ -16,11 +16,52 @@
  */
 
 
+/* With SPRITZ_HEADER_ONLY, This file is included by SpritzCipher.h */
+#ifndef SPRITZCIPHER_C
+#define SPRITZCIPHER_C
+
 #include "SpritzCipher.h" /* Data types and constants */
 
 
-#define SPRITZ_N_MINUS_1 255U /* SPRITZ_N - 1 */
-#define SPRITZ_N_HALF 128U /* SPRITZ_N / 2 */
+#define SPRITZ_N_MINUS_1 (SPRITZ_N - 1U) /* Mask for the `% SPRITZ_N` of indices */
+#define SPRITZ_N_HALF (SPRITZ_N / 2U)
+#define SPRITZ_WHIP_UPDATES (SPRITZ_N * 2U) /* spritz_update() calls in spritz_whip() */
+
+/* SPRITZ_N_BITS:      Bits in an output of spritz_drip(), log2(SPRITZ_N).
+ * SPRITZ_NIBBLE_BITS: Bits in an absorbed nibble, ceil(SPRITZ_N_BITS / 2).
+ */
+#if SPRITZ_N == 256U
+# define SPRITZ_N_BITS 8U
+# define SPRITZ_NIBBLE_BITS 4U
+#elif SPRITZ_N == 128U
+# define SPRITZ_N_BITS 7U
+# define SPRITZ_NIBBLE_BITS 4U
+#elif SPRITZ_N == 64U
+# define SPRITZ_N_BITS 6U
+# define SPRITZ_NIBBLE_BITS 3U
+#elif SPRITZ_N == 32U
+# define SPRITZ_N_BITS 5U
+# define SPRITZ_NIBBLE_BITS 3U
+#elif SPRITZ_N == 16U
+# define SPRITZ_N_BITS 4U
+# define SPRITZ_NIBBLE_BITS 2U
+#else
+# error "SPRITZ_N must be 16, 32, 64, 128 or 256."
+#endif
+
+#if (SPRITZ_ENTROPY_RING_SIZE < 2U) || (SPRITZ_ENTROPY_RING_SIZE > 128U) \
+  || (SPRITZ_ENTROPY_RING_SIZE & (SPRITZ_ENTROPY_RING_SIZE - 1U))
+# error "SPRITZ_ENTROPY_RING_SIZE must be a power of 2 and not bigger than 128."
+#endif
+
+/* Memory barrier between the entropy ring buffer and its indices access */
+#if defined(__AVR__)
+# define SPRITZ_MEMORY_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+#elif defined(__GNUC__) || defined(__clang__)
+# define SPRITZ_MEMORY_BARRIER() __sync_synchronize()
+#else
+# define SPRITZ_MEMORY_BARRIER()
+#endif
 
 
 static inline void
@@ -43,10 +84,10 @@ spritz_state_init(spritz_ctx *ctx)
 {
   uint8_t i = 0;
 
-  /* Loop for SPRITZ_N=256 */
+  /* Loop for SPRITZ_N, `(uint8_t)SPRITZ_N` is 0 if SPRITZ_N=256 */
   do {
     ctx->s[i] = i;
-  } while (++i);
+  } while (++i != (uint8_t)SPRITZ_N);
 
   ctx->i = 0;
   ctx->j = 0;
@@ -54,33 +95,108 @@ spritz_state_init(spritz_ctx *ctx)
   ctx->z = 0;
   ctx->a = 0;
   ctx->w = 1U;
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+  ctx->shuffle_pos = 0;
+#endif
 }
 
 static inline void
-update(spritz_ctx *ctx)
+spritz_update(spritz_ctx *ctx)
 {
-  ctx->i = (uint8_t)(ctx->i + ctx->w);
-  ctx->j = (uint8_t)(ctx->s[(uint8_t)(ctx->s[ctx->i] + ctx->j)] + ctx->k);
-  ctx->k = (uint8_t)(ctx->s[ctx->j] + ctx->k + ctx->i);
+  ctx->i = (uint8_t)((ctx->i + ctx->w) & SPRITZ_N_MINUS_1);
+  ctx->j = (uint8_t)((ctx->s[(ctx->s[ctx->i] + ctx->j) & SPRITZ_N_MINUS_1] + ctx->k) & SPRITZ_N_MINUS_1);
+  ctx->k = (uint8_t)((ctx->s[ctx->j] + ctx->k + ctx->i) & SPRITZ_N_MINUS_1);
   spritz_state_s_swap(ctx, ctx->i, ctx->j);
 }
 
+#ifndef SPRITZ_WIPE_TRACES_PARANOID
+/* Type of the local variables in spritz_updates(),
+ * 8-bit on AVR, Native width in other CPUs to avoid partial register access.
+ */
+# if defined(__AVR__)
+typedef uint8_t spritz_reg_t;
+# else
+typedef unsigned int spritz_reg_t;
+# endif
+
+/* spritz_update() with the registers i, j, k, w in local variables,
+ * `s_i` is a temporary variable for the swap.
+ * Indices are masked with SPRITZ_N_MINUS_1 since the locals may be wider than 8-bit.
+ */
+# define SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i) \
+  do { \
+    (i)      = ((i) + (w)) & SPRITZ_N_MINUS_1; \
+    (s_i)    = (s)[(i)]; \
+    (j)      = ((s)[((s_i) + (j)) & SPRITZ_N_MINUS_1] + (k)) & SPRITZ_N_MINUS_1; \
+    (k)      = ((s)[(j)] + (k) + (i)) & SPRITZ_N_MINUS_1; \
+    (s)[(i)] = (s)[(j)]; \
+    (s)[(j)] = (uint8_t)(s_i); \
+  } while (0)
+#endif /* SPRITZ_WIPE_TRACES_PARANOID */
+
+/* Run `n` spritz_update() */
 static inline void
-whip(spritz_ctx *ctx)
+spritz_updates(spritz_ctx *ctx, uint16_t n)
 {
-  uint8_t i;
-
-  for (i = 0; i < SPRITZ_N_HALF; i++) {
-    update(ctx);
-    update(ctx);
-    update(ctx);
-    update(ctx);
+#ifdef SPRITZ_WIPE_TRACES_PARANOID
+  for (; n >= 4U; n -= 4U) {
+    spritz_update(ctx);
+    spritz_update(ctx);
+    spritz_update(ctx);
+    spritz_update(ctx);
+  }
+  for (; n; n--) {
+    spritz_update(ctx);
+  }
+#else
+  /* Load i, j, k, w once, So the compiler can keep them in CPU registers
+   * for all the updates instead of reading and writing them through `ctx`.
+   */
+  spritz_reg_t i = ctx->i, j = ctx->j, k = ctx->k, s_i;
+  const spritz_reg_t w = ctx->w;
+  uint8_t *s = ctx->s;
+
+  for (; n >= 4U; n -= 4U) {
+    SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i);
+    SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i);
+    SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i);
+    SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i);
+  }
+  for (; n; n--) {
+    SPRITZ_UPDATE_LOCAL(s, i, j, k, w, s_i);
   }
 
-  ctx->w = (uint8_t)(ctx->w + 2U);
+  ctx->i = (uint8_t)i;
+  ctx->j = (uint8_t)j;
+  ctx->k = (uint8_t)k;
+#endif /* SPRITZ_WIPE_TRACES_PARANOID */
+}
+
+static inline void
+spritz_whip(spritz_ctx *ctx)
+{
+  spritz_updates(ctx, SPRITZ_WHIP_UPDATES);
+  ctx->w = (uint8_t)((ctx->w + 2U) & SPRITZ_N_MINUS_1);
 }
 
-#ifdef SPRITZ_TIMING_SAFE_CRUSH
+#if defined(SPRITZ_WIPE_TRACES_PARANOID_FAST)
+/* Branchless equal time spritz_crush(), It does not need disabled optimization */
+static inline void
+spritz_crush(spritz_ctx *ctx)
+{
+  uint8_t i = 0, j = SPRITZ_N_MINUS_1;
+  uint8_t s_i, s_j, x;
+  for (; i < SPRITZ_N_HALF; i++, j--) {
+    s_i = ctx->s[i];
+    s_j = ctx->s[j];
+    /* 0xFF if s_i > s_j (borrow of s_j - s_i), Else 0x00 */
+    x = (uint8_t)((uint16_t)((uint16_t)s_j - (uint16_t)s_i) >> 8);
+    x &= (uint8_t)(s_i ^ s_j);
+    ctx->s[i] = (uint8_t)(s_i ^ x);
+    ctx->s[j] = (uint8_t)(s_j ^ x);
+  }
+}
+#elif defined(SPRITZ_TIMING_SAFE_CRUSH)
 static inline void
 /* SPRITZ_TIMING_SAFE_CRUSH and GCC, disable optimization for this function */
 # if defined(__GNUC__) && !defined(__clang__)
@@ -89,7 +205,7 @@ __attribute__ ((optimize("O0")))
 # elif defined(__clang__)
 __attribute__ ((optnone))
 # endif
-crush(spritz_ctx *ctx)
+spritz_crush(spritz_ctx *ctx)
 {
   uint8_t i = 0, j = SPRITZ_N_MINUS_1;
 # ifdef SPRITZ_WIPE_TRACES_PARANOID
@@ -122,9 +238,9 @@ crush(spritz_ctx *ctx)
 # endif /* SPRITZ_WIPE_TRACES_PARANOID */
 }
 #else /* SPRITZ_TIMING_SAFE_CRUSH */
-/* non equal/safe time crush() */
+/* non equal/safe time spritz_crush() */
 static void
-crush(spritz_ctx *ctx)
+spritz_crush(spritz_ctx *ctx)
 {
   uint8_t i = 0, j = SPRITZ_N_MINUS_1;
   for (; i < SPRITZ_N_HALF; i++, j--) {
@@ -135,68 +251,226 @@ crush(spritz_ctx *ctx)
 }
 #endif /* SPRITZ_TIMING_SAFE_CRUSH */
 
+#ifdef SPRITZ_WIPE_TRACES_PARANOID_FAST
+/* The spritz_shuffle() work is done in its own (not inlined) function,
+ * So its stack frame is below the library function that calls it,
+ * And it is wiped by SPRITZ_WIPE_STACK() at the exit of that function.
+ */
+# define SPRITZ_SHUFFLE_FRAME __attribute__ ((noinline)) SPRITZ_WIPE_REGS
+/* At the exit of the library functions that use the spritz state */
+# define SPRITZ_WIPE_STACK() spritz_wipe_stack()
+
+/* Wipe SPRITZ_WIPE_STACK_SIZE bytes of the stack below the caller.
+ * It is called often, So it is optimized: The empty `asm` that reads `buf`
+ * keeps the writes (GCC and Clang), Else `volatile` does.
+ */
+static void
+# if defined(__GNUC__) || defined(__clang__)
+__attribute__ ((noinline))
+# endif
+spritz_wipe_stack(void)
+{
+# if defined(__GNUC__) || defined(__clang__)
+  uint8_t buf[SPRITZ_WIPE_STACK_SIZE];
+# else
+  volatile uint8_t buf[SPRITZ_WIPE_STACK_SIZE];
+# endif
+  uint16_t i;
+
+  for (i = 0; i < SPRITZ_WIPE_STACK_SIZE; i++) {
+    buf[i] = 0;
+  }
+# if defined(__GNUC__) || defined(__clang__)
+  __asm__ __volatile__ ("" : : "r" (buf) : "memory");
+# endif
+}
+#else /* SPRITZ_WIPE_TRACES_PARANOID_FAST */
+# define SPRITZ_SHUFFLE_FRAME
+# define SPRITZ_WIPE_STACK()
+#endif /* SPRITZ_WIPE_TRACES_PARANOID_FAST */
+
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+/* Run up to `max_updates` spritz_update() of the spritz_shuffle() in progress,
+ * Start it if there is no one. The spritz_crush() between the spritz_whip() calls is
+ * done with the last spritz_update() of its spritz_whip().
+ * `shuffle_pos` is 0 if no spritz_shuffle() is in progress, Else 1 + the done spritz_update() calls.
+ * Return non-zero if the spritz_shuffle() is done.
+ */
+static SPRITZ_SHUFFLE_FRAME uint8_t
+spritz_shuffle_resume(spritz_ctx *ctx, uint16_t max_updates)
+{
+  uint16_t done, n;
+
+  if (max_updates == 0) {
+    return 0; /* Do not start a shuffle that does no step */
+  }
+  if (ctx->shuffle_pos == 0) {
+    ctx->shuffle_pos = 1U;
+  }
+
+  for (;;) {
+    done = (uint16_t)(ctx->shuffle_pos - 1U);
+    if (done == (3U * SPRITZ_WHIP_UPDATES)) {
+      ctx->shuffle_pos = 0;
+      ctx->a = 0;
+      return 1U;
+    }
+
+    /* spritz_update() calls left in the current spritz_whip() */
+    n = (uint16_t)(SPRITZ_WHIP_UPDATES - (done % SPRITZ_WHIP_UPDATES));
+    if (n > max_updates) {
+      n = max_updates;
+    }
+    if (n == 0) {
+      return 0;
+    }
+
+    spritz_updates(ctx, n);
+    max_updates = (uint16_t)(max_updates - n);
+    done = (uint16_t)(done + n);
+    ctx->shuffle_pos = (uint16_t)(done + 1U);
+
+    if ((done % SPRITZ_WHIP_UPDATES) == 0) { /* End of spritz_whip() */
+      ctx->w = (uint8_t)((ctx->w + 2U) & SPRITZ_N_MINUS_1);
+      if (done != (3U * SPRITZ_WHIP_UPDATES)) {
+        spritz_crush(ctx);
+      }
+    }
+  }
+}
+
+/* Do the spritz_shuffle(), Or finish the one in progress */
+static inline void
+spritz_shuffle(spritz_ctx *ctx)
+{
+  spritz_shuffle_resume(ctx, 0xFFFFU);
+}
+
+/* Absorbing is not allowed in the middle of a spritz_shuffle() */
+# define SPRITZ_SHUFFLE_IN_PROGRESS(ctx) ((ctx)->shuffle_pos)
+#else /* SPRITZ_COOPERATIVE_SHUFFLE */
+# ifdef SPRITZ_WIPE_TRACES_PARANOID_FAST
+static SPRITZ_SHUFFLE_FRAME void
+# else
 static inline void
-shuffle(spritz_ctx *ctx)
+# endif
+spritz_shuffle_work(spritz_ctx *ctx)
 {
-  whip(ctx);
-  crush(ctx);
-  whip(ctx);
-  crush(ctx);
-  whip(ctx);
+  spritz_whip(ctx);
+  spritz_crush(ctx);
+  spritz_whip(ctx);
+  spritz_crush(ctx);
+  spritz_whip(ctx);
   ctx->a = 0;
 }
 
+static inline void
+spritz_shuffle(spritz_ctx *ctx)
+{
+  spritz_shuffle_work(ctx);
+}
+
+# define SPRITZ_SHUFFLE_IN_PROGRESS(ctx) 0
+#endif /* SPRITZ_COOPERATIVE_SHUFFLE */
+
+/* Domain byte absorbed by spritz_xof_final() ('X') */
+#define SPRITZ_XOF_DOMAIN 0x58U
+
 /* Note: Nibble=4-bit; Octet=2*Nibble=8-bit; Byte=Octet (in modern/most computers) */
 static inline void
-absorbNibble(spritz_ctx *ctx, const uint8_t nibble)
+spritz_absorb_nibble(spritz_ctx *ctx, const uint8_t nibble)
 {
-  if (ctx->a == SPRITZ_N_HALF) {
-    shuffle(ctx);
+  if (ctx->a == SPRITZ_N_HALF || SPRITZ_SHUFFLE_IN_PROGRESS(ctx)) {
+    spritz_shuffle(ctx);
   }
   spritz_state_s_swap(ctx, ctx->a, (uint8_t)(SPRITZ_N_HALF + nibble));
   ctx->a++;
 }
 static inline void
-absorb(spritz_ctx *ctx, const uint8_t octet)
+spritz_absorb(spritz_ctx *ctx, const uint8_t octet)
 {
-  absorbNibble(ctx, octet % 16); /* With the Right/Low nibble */
-  absorbNibble(ctx, octet / 16); /* With the Left/High nibble */
+#if SPRITZ_N == 256U
+  spritz_absorb_nibble(ctx, octet % 16); /* With the Right/Low nibble */
+  spritz_absorb_nibble(ctx, octet / 16); /* With the Left/High nibble */
+#else
+  /* Nibbles of SPRITZ_NIBBLE_BITS, From the Right/Low one */
+  uint8_t b;
+
+  for (b = 0; b < 8U; b += SPRITZ_NIBBLE_BITS) {
+    spritz_absorb_nibble(ctx, (uint8_t)((octet >> b) & ((1U << SPRITZ_NIBBLE_BITS) - 1U)));
+  }
+#endif
 }
 static inline void
-absorbBytes(spritz_ctx *ctx, const uint8_t *buf, uint16_t len)
+spritz_absorb_bytes(spritz_ctx *ctx, const uint8_t *buf, uint16_t len)
 {
   uint16_t i;
 
   for (i = 0; i < len; i++) {
-    absorb(ctx, buf[i]);
+    spritz_absorb(ctx, buf[i]);
   }
 }
 
 static inline void
-absorbStop(spritz_ctx *ctx)
+spritz_absorb_stop(spritz_ctx *ctx)
 {
-  if (ctx->a == SPRITZ_N_HALF) {
-    shuffle(ctx);
+  if (ctx->a == SPRITZ_N_HALF || SPRITZ_SHUFFLE_IN_PROGRESS(ctx)) {
+    spritz_shuffle(ctx);
   }
 
   ctx->a++;
 }
 
 static inline uint8_t
-output(spritz_ctx *ctx)
+spritz_output(spritz_ctx *ctx)
 {
   ctx->z = ctx->s[(ctx->s[(ctx->s[(ctx->z + ctx->k) % SPRITZ_N] + ctx->i) % SPRITZ_N] + ctx->j) % SPRITZ_N];
   return ctx->z;
 }
 
 static inline uint8_t
-drip(spritz_ctx *ctx)
+spritz_drip(spritz_ctx *ctx)
+{
+  if (ctx->a) {
+    spritz_shuffle(ctx);
+  }
+  spritz_update(ctx);
+  return spritz_output(ctx);
+}
+
+/* Output a byte of keystream */
+static inline uint8_t
+spritz_drip_byte(spritz_ctx *ctx)
 {
+#if SPRITZ_N == 256U
+  return spritz_drip(ctx);
+#else
+  /* Many outputs of SPRITZ_N_BITS, From the Right/Low bits */
+  uint8_t octet = spritz_drip(ctx);
+  uint8_t b;
+
+  for (b = SPRITZ_N_BITS; b < 8U; b += SPRITZ_N_BITS) {
+    octet |= (uint8_t)(spritz_drip(ctx) << b);
+  }
+  return octet;
+#endif
+}
+
+/* Output the hash or MAC digest, Same for spritz_hash_final() and spritz_mac_final() */
+static inline void
+spritz_squeeze_digest(spritz_ctx *ctx, uint8_t *digest, uint8_t digestLen)
+{
+  uint8_t i;
+
+  spritz_absorb_stop(ctx);
+  spritz_absorb(ctx, digestLen);
+  /* squeeze() */
   if (ctx->a) {
-    shuffle(ctx);
+    spritz_shuffle(ctx);
+  }
+  for (i = 0; i < digestLen; i++) {
+    digest[i] = spritz_drip_byte(ctx);
   }
-  update(ctx);
-  return output(ctx);
 }
 
 
@@ -214,7 +488,7 @@ drip(spritz_ctx *ctx)
  *         Zero (0x00) if `data_a` equals `data_b` OR if `len` is zero,
  *         Non-zero value if they are NOT equal.
  */
-uint8_t
+SPRITZ_API uint8_t
 /* Disable optimization for this function if compiler is GCC */
 #if defined(__GNUC__) && !defined(__clang__)
 __attribute__ ((optimize("O0")))
@@ -231,7 +505,7 @@ spritz_compare(const uint8_t *data_a, const uint8_t *data_b, uint16_t len)
     d |= data_a[i] ^ data_b[i];
   }
 
-#ifdef SPRITZ_WIPE_TRACES_PARANOID
+#if defined(SPRITZ_WIPE_TRACES_PARANOID) || defined(SPRITZ_WIPE_TRACES_PARANOID_FAST)
 # if !defined(__GNUC__) && !defined(__clang__)
   /* Not GCC or Clang, Optimization isn't off. */
   /* It may be possible to use `d=!!d;` for performnce,
@@ -255,7 +529,7 @@ spritz_compare(const uint8_t *data_a, const uint8_t *data_b, uint16_t len)
     d = 1U;
   }
 # endif /* !defined(__GNUC__) && !defined(__clang__) */
-#endif /* SPRITZ_WIPE_TRACES_PARANOID */
+#endif /* SPRITZ_WIPE_TRACES_PARANOID || SPRITZ_WIPE_TRACES_PARANOID_FAST */
 
   return d;
 }
@@ -266,7 +540,7 @@ spritz_compare(const uint8_t *data_a, const uint8_t *data_b, uint16_t len)
  * Parameter buf: Data to replace it with zeros (0x00).
  * Parameter len: Length of array in bytes.
  */
-void
+SPRITZ_API void
 /* Disable optimization for this function if compiler is GCC */
 #if defined(__GNUC__) && !defined(__clang__)
 __attribute__ ((optimize("O0")))
@@ -292,7 +566,7 @@ spritz_memzero(uint8_t *buf, uint16_t len)
  *
  * Parameter ctx: The context.
  */
-void
+SPRITZ_API void
 /* Disable optimization for this function if compiler is GCC */
 #if defined(__GNUC__) && !defined(__clang__)
 __attribute__ ((optimize("O0")))
@@ -306,10 +580,10 @@ spritz_state_memzero(spritz_ctx *ctx)
   memset(ctx->s, 0, SPRITZ_N);
 #else
   uint8_t i = 0;
-  /* Loop for SPRITZ_N=256 */
+  /* Loop for SPRITZ_N, `(uint8_t)SPRITZ_N` is 0 if SPRITZ_N=256 */
   do {
     ctx->s[i] = 0;
-  } while (++i);
+  } while (++i != (uint8_t)SPRITZ_N);
 #endif
 
   ctx->i = 0;
@@ -323,6 +597,9 @@ spritz_state_memzero(spritz_ctx *ctx)
   ctx->tmp1 = 0;
   ctx->tmp2 = 0;
 #endif
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+  ctx->shuffle_pos = 0;
+#endif
 }
 
 
@@ -333,15 +610,20 @@ spritz_state_memzero(spritz_ctx *ctx)
  * Parameter key:    The key.
  * Parameter keylen: Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_setup(spritz_ctx *ctx,
              const uint8_t *key, uint8_t keyLen)
 {
   spritz_state_init(ctx);
-  absorbBytes(ctx, key, keyLen);
+  spritz_absorb_bytes(ctx, key, keyLen);
   if (ctx->a) {
-    shuffle(ctx);
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+    ctx->shuffle_pos = 1U; /* Done by spritz_step() or the first output */
+#else
+    spritz_shuffle(ctx);
+#endif
   }
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_setup_withiv()
@@ -353,20 +635,66 @@ spritz_setup(spritz_ctx *ctx,
  * Parameter nonce:    The nonce (salt).
  * Parameter noncelen: Length of the nonce in bytes.
  */
-void
+SPRITZ_API void
 spritz_setup_withIV(spritz_ctx *ctx,
                     const uint8_t *key, uint8_t keyLen,
                     const uint8_t *nonce, uint8_t nonceLen)
 {
   spritz_state_init(ctx);
-  absorbBytes(ctx, key, keyLen);
-  absorbStop(ctx);
-  absorbBytes(ctx, nonce, nonceLen);
+  spritz_absorb_bytes(ctx, key, keyLen);
+  spritz_absorb_stop(ctx);
+  spritz_absorb_bytes(ctx, nonce, nonceLen);
   if (ctx->a) {
-    shuffle(ctx);
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+    ctx->shuffle_pos = 1U; /* Done by spritz_step() or the first output */
+#else
+    spritz_shuffle(ctx);
+#endif
+  }
+  SPRITZ_WIPE_STACK();
+}
+
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+/** spritz_step()
+ * Do up to `max_updates` steps of the shuffle pending from spritz_setup() or
+ * spritz_setup_withiv(), To split it over many calls (e.g. from a real-time loop).
+ * A shuffle is 6*SPRITZ_N steps (1536 for N=256), The output is the same as without spritz_step().
+ * The shuffle pending from spritz_add_entropy() is not done by spritz_step(),
+ * It is done by the next output like without SPRITZ_COOPERATIVE_SHUFFLE.
+ * Not for hash and MAC contexts.
+ * Available only if SPRITZ_COOPERATIVE_SHUFFLE is defined.
+ *
+ * Parameter ctx:         The context.
+ * Parameter max_updates: Maximum number of steps (spritz_update() calls) to do.
+ *
+ * Return: Non-zero value if the setup shuffle is done, Else zero (0x00).
+ */
+SPRITZ_API uint8_t
+spritz_step(spritz_ctx *ctx, uint16_t max_updates)
+{
+  uint8_t ready = 1U;
+  if (ctx->shuffle_pos != 0) {
+    ready = spritz_shuffle_resume(ctx, max_updates);
+    SPRITZ_WIPE_STACK();
   }
+  return ready;
 }
 
+/** spritz_is_ready()
+ * Check if the shuffle pending from spritz_setup() or spritz_setup_withiv() is done.
+ * Available only if SPRITZ_COOPERATIVE_SHUFFLE is defined.
+ *
+ * Parameter ctx: The context.
+ *
+ * Return: Non-zero value if the setup shuffle is done, Else zero (0x00).
+ */
+SPRITZ_API uint8_t
+spritz_is_ready(const spritz_ctx *ctx)
+{
+  return (uint8_t)(ctx->shuffle_pos == 0);
+}
+#endif /* SPRITZ_COOPERATIVE_SHUFFLE */
+
 /** spritz_random8()
  * Generates a random byte from the spritz state `spritz_ctx`.
  * Usable only after calling spritz_setup() or spritz_setup_withiv().
@@ -375,10 +703,13 @@ spritz_setup_withIV(spritz_ctx *ctx,
  *
  * Return: Byte of keystream.
  */
-uint8_t
+SPRITZ_API uint8_t
 spritz_random8(spritz_ctx *ctx)
 {
-  return drip(ctx);
+  uint8_t octet = spritz_drip_byte(ctx);
+
+  SPRITZ_WIPE_STACK();
+  return octet;
 }
 
 /** spritz_random32()
@@ -389,14 +720,17 @@ spritz_random8(spritz_ctx *ctx)
  *
  * Return: 32-bit (4 bytes) of keystream.
  */
-uint32_t
+SPRITZ_API uint32_t
 spritz_random32(spritz_ctx *ctx)
 {
-  return (uint32_t)(
-      ((uint32_t)(drip(ctx)) <<  0)
-    | ((uint32_t)(drip(ctx)) <<  8)
-    | ((uint32_t)(drip(ctx)) << 16)
-    | ((uint32_t)(drip(ctx)) << 24));
+  uint32_t r = (uint32_t)(
+      ((uint32_t)(spritz_drip_byte(ctx)) <<  0)
+    | ((uint32_t)(spritz_drip_byte(ctx)) <<  8)
+    | ((uint32_t)(spritz_drip_byte(ctx)) << 16)
+    | ((uint32_t)(spritz_drip_byte(ctx)) << 24));
+
+  SPRITZ_WIPE_STACK();
+  return r;
 }
 
 /** spritz_random32_uniform()
@@ -416,7 +750,7 @@ spritz_random32(spritz_ctx *ctx)
  *
  * Return: Random number less than upper_bound, 0 if upper_bound<2.
  */
-uint32_t
+SPRITZ_API uint32_t
 spritz_random32_uniform(spritz_ctx *ctx, uint32_t upper_bound)
 {
   uint32_t r, min;
@@ -444,22 +778,103 @@ spritz_random32_uniform(spritz_ctx *ctx, uint32_t upper_bound)
 }
 
 /** spritz_add_entropy()
- * Add entropy to the spritz state `spritz_ctx` using absorb().
+ * Add entropy to the spritz state `spritz_ctx` using spritz_absorb().
  * Usable only after calling spritz_setup() or spritz_setup_withiv().
  *
  * Parameter ctx:     The context.
  * Parameter entropy: The entropy array.
  * Parameter len:     Length of the entropy array in bytes.
  */
-void
+SPRITZ_API void
 spritz_add_entropy(spritz_ctx *ctx,
             const uint8_t *entropy, uint16_t len)
 {
-  absorbBytes(ctx, entropy, len);
+  spritz_absorb_bytes(ctx, entropy, len);
+  SPRITZ_WIPE_STACK();
+}
+
+/** spritz_entropy_ring_init()
+ * Setup an empty entropy ring `spritz_entropy_ring`.
+ *
+ * Parameter ring: The entropy ring.
+ */
+SPRITZ_API void
+spritz_entropy_ring_init(spritz_entropy_ring *ring)
+{
+  uint8_t i;
+
+  for (i = 0; i < SPRITZ_ENTROPY_RING_SIZE; i++) {
+    ring->buf[i] = 0;
+  }
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+/** spritz_entropy_ring_push()
+ * Add an entropy byte to the ring in constant time,
+ * Can be called from an interrupt handler (ISR) or a signal handler.
+ * Only one producer can push to the ring.
+ *
+ * Parameter ring:  The entropy ring.
+ * Parameter octet: The entropy byte.
+ *
+ * Return: Zero (0x00) if the byte is added, Non-zero value if the ring is full.
+ */
+SPRITZ_API uint8_t
+spritz_entropy_ring_push(spritz_entropy_ring *ring, uint8_t octet)
+{
+  uint8_t head = ring->head;
+
+  /* `head` and `tail` are free running, Their difference is the used size */
+  if ((uint8_t)(head - ring->tail) >= SPRITZ_ENTROPY_RING_SIZE) {
+    return 1U;
+  }
+
+  ring->buf[head & (SPRITZ_ENTROPY_RING_SIZE - 1U)] = octet;
+  SPRITZ_MEMORY_BARRIER(); /* The byte is written before it is published */
+  ring->head = (uint8_t)(head + 1U);
+
+  return 0;
+}
+
+/** spritz_entropy_ring_drain()
+ * Add the entropy in the ring to the spritz state `spritz_ctx`
+ * like spritz_add_entropy(), And empty the ring.
+ * Only one consumer can drain the ring, NOT from an interrupt handler.
+ * Usable only after calling spritz_setup() or spritz_setup_withiv().
+ *
+ * Parameter ctx:  The context.
+ * Parameter ring: The entropy ring.
+ *
+ * Return: Number of the added entropy bytes.
+ */
+SPRITZ_API uint16_t
+spritz_entropy_ring_drain(spritz_ctx *ctx, spritz_entropy_ring *ring)
+{
+  uint8_t tail = ring->tail;
+  uint8_t head = ring->head;
+  uint16_t n = 0;
+
+  SPRITZ_MEMORY_BARRIER(); /* Read `head` before the bytes it published */
+  while (tail != head) {
+    spritz_absorb(ctx, ring->buf[tail & (SPRITZ_ENTROPY_RING_SIZE - 1U)]);
+#ifdef SPRITZ_WIPE_TRACES
+    ring->buf[tail & (SPRITZ_ENTROPY_RING_SIZE - 1U)] = 0;
+#endif
+    tail++;
+    n++;
+  }
+  SPRITZ_MEMORY_BARRIER(); /* Done with the bytes before they are released */
+  ring->tail = tail;
+
+  SPRITZ_WIPE_STACK();
+  return n;
 }
 
 /** spritz_crypt()
  * Encrypt or decrypt data chunk by XOR-ing it with the spritz keystream.
+ * The keystream continues from a call to the next one, So a message held
+ * in many buffers can be processed chunk by chunk, `data` can be `dataout`.
  * Usable only after calling spritz_setup() or spritz_setup_withiv().
  *
  * Parameter ctx:     The context.
@@ -467,7 +882,7 @@ spritz_add_entropy(spritz_ctx *ctx,
  * Parameter datalen: Length of the data in bytes.
  * Parameter dataout: The output.
  */
-void
+SPRITZ_API void
 spritz_crypt(spritz_ctx *ctx,
              const uint8_t *data, uint16_t dataLen,
              uint8_t *dataOut)
@@ -475,8 +890,9 @@ spritz_crypt(spritz_ctx *ctx,
   uint16_t i;
 
   for (i = 0; i < dataLen; i++) {
-    dataOut[i] = data[i] ^ drip(ctx);
+    dataOut[i] = data[i] ^ spritz_drip_byte(ctx);
   }
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_crypt_inplace()
@@ -488,15 +904,16 @@ spritz_crypt(spritz_ctx *ctx,
  * Parameter data:    The data to encrypt or decrypt, also the output.
  * Parameter datalen: Length of the data in bytes.
  */
-void
+SPRITZ_API void
 spritz_crypt_inplace(spritz_ctx *ctx,
                      uint8_t *data, uint16_t dataLen)
 {
   uint16_t i;
 
   for (i = 0; i < dataLen; i++) {
-    data[i] ^= drip(ctx);
+    data[i] ^= spritz_drip_byte(ctx);
   }
+  SPRITZ_WIPE_STACK();
 }
 
 
@@ -505,7 +922,7 @@ spritz_crypt_inplace(spritz_ctx *ctx,
  *
  * Parameter hash_ctx: The hash context (ctx).
  */
-void
+SPRITZ_API void
 spritz_hash_setup(spritz_ctx *hash_ctx)
 {
   spritz_state_init(hash_ctx);
@@ -513,16 +930,18 @@ spritz_hash_setup(spritz_ctx *hash_ctx)
 
 /** spritz_hash_update()
  * Add a message/data chunk `data` to hash.
+ * Hashing chunk by chunk gives the same digest as hashing all the data at once.
  *
  * Parameter hash_ctx: The hash context (ctx).
  * Parameter data:     The data chunk to hash.
  * Parameter datalen:  Length of the data in bytes.
  */
-void
+SPRITZ_API void
 spritz_hash_update(spritz_ctx *hash_ctx,
                    const uint8_t *data, uint16_t dataLen)
 {
-  absorbBytes(hash_ctx, data, dataLen);
+  spritz_absorb_bytes(hash_ctx, data, dataLen);
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_hash_final()
@@ -532,59 +951,62 @@ spritz_hash_update(spritz_ctx *hash_ctx,
  * Parameter digest:    The digest (hash) output.
  * Parameter digestlen: Length of the digest in bytes.
  */
-void
+SPRITZ_API void
 spritz_hash_final(spritz_ctx *hash_ctx,
                   uint8_t *digest, uint8_t digestLen)
 {
-  uint8_t i;
-
-  absorbStop(hash_ctx);
-  absorb(hash_ctx, digestLen);
-  /* squeeze() */
-  if (hash_ctx->a) {
-    shuffle(hash_ctx);
-  }
-  for (i = 0; i < digestLen; i++) {
-    digest[i] = drip(hash_ctx);
-  }
+  spritz_squeeze_digest(hash_ctx, digest, digestLen);
+  SPRITZ_WIPE_STACK();
 }
 
-/** spritz_hash()
- * Cryptographic hash function.
+/** spritz_hash_withCtx()
+ * Cryptographic hash function, Same as spritz_hash() but uses the
+ * caller's context `hash_ctx` instead of a local one (Stack saving).
+ * If SPRITZ_WIPE_TRACES is defined, `hash_ctx` will be wiped.
  *
+ * Parameter hash_ctx:  The hash context (ctx) to work with.
  * Parameter digest:    The digest (hash) output.
  * Parameter digestlen: Length of the digest in bytes.
  * Parameter data:      The data to hash.
  * Parameter datalen:   Length of the data in bytes.
  */
-void
-spritz_hash(uint8_t *digest, uint8_t digestLen,
-            const uint8_t *data, uint16_t dataLen)
+SPRITZ_API void
+spritz_hash_withCtx(spritz_ctx *hash_ctx,
+                    uint8_t *digest, uint8_t digestLen,
+                    const uint8_t *data, uint16_t dataLen)
 {
-  uint8_t i;
-  spritz_ctx hash_ctx;
-
   /* spritz_hash_setup() */
-  spritz_state_init(&hash_ctx);
+  spritz_state_init(hash_ctx);
 
   /* spritz_hash_update() */
-  absorbBytes(&hash_ctx, data, dataLen);
+  spritz_absorb_bytes(hash_ctx, data, dataLen);
 
-  /* Same as spritz_hash_final() */
-  absorbStop(&hash_ctx);
-  absorb(&hash_ctx, digestLen);
-  /* squeeze() */
-  if (hash_ctx.a) {
-    shuffle(&hash_ctx);
-  }
-  for (i = 0; i < digestLen; i++) {
-    digest[i] = drip(&hash_ctx);
-  }
+  /* spritz_hash_final() */
+  spritz_squeeze_digest(hash_ctx, digest, digestLen);
 
   /* `hash_ctx` data will be replaced with 0x00 if SPRITZ_WIPE_TRACES is defined */
 #ifdef SPRITZ_WIPE_TRACES
-  spritz_state_memzero(&hash_ctx);
+  spritz_state_memzero(hash_ctx);
 #endif
+  SPRITZ_WIPE_STACK();
+}
+
+/** spritz_hash()
+ * Cryptographic hash function.
+ *
+ * Parameter digest:    The digest (hash) output.
+ * Parameter digestlen: Length of the digest in bytes.
+ * Parameter data:      The data to hash.
+ * Parameter datalen:   Length of the data in bytes.
+ */
+SPRITZ_API void
+spritz_hash(uint8_t *digest, uint8_t digestLen,
+            const uint8_t *data, uint16_t dataLen)
+{
+  spritz_ctx hash_ctx;
+
+  spritz_hash_withCtx(&hash_ctx, digest, digestLen, data, dataLen);
+  SPRITZ_WIPE_STACK();
 }
 
 
@@ -595,27 +1017,30 @@ spritz_hash(uint8_t *digest, uint8_t digestLen,
  * Parameter key:     The secret key.
  * Parameter keylen:  Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_setup(spritz_ctx *mac_ctx,
                  const uint8_t *key, uint16_t keyLen)
 {
   spritz_state_init(mac_ctx); /* spritz_hash_setup() */
-  absorbBytes(mac_ctx, key, keyLen); /* spritz_hash_update() */
-  absorbStop(mac_ctx);
+  spritz_absorb_bytes(mac_ctx, key, keyLen); /* spritz_hash_update() */
+  spritz_absorb_stop(mac_ctx);
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_mac_update()
  * Add a message/data chunk to message authentication code (MAC).
+ * Adding chunk by chunk gives the same digest as adding all the message at once.
  *
  * Parameter hash_ctx: The hash context (ctx).
  * Parameter msg:      The message chunk to be authenticated.
  * Parameter msglen:   Length of the message in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_update(spritz_ctx *mac_ctx,
                   const uint8_t *msg, uint16_t msgLen)
 {
-  absorbBytes(mac_ctx, msg, msgLen); /* spritz_hash_update() */
+  spritz_absorb_bytes(mac_ctx, msg, msgLen); /* spritz_hash_update() */
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_mac_final()
@@ -625,22 +1050,49 @@ spritz_mac_update(spritz_ctx *mac_ctx,
  * Parameter digest:    Message authentication code (MAC) digest output.
  * Parameter digestlen: Length of the digest in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_final(spritz_ctx *mac_ctx,
                  uint8_t *digest, uint8_t digestLen)
 {
-  /* Same as spritz_hash_final() */
-  uint8_t i;
+  spritz_squeeze_digest(mac_ctx, digest, digestLen); /* Same as spritz_hash_final() */
+  SPRITZ_WIPE_STACK();
+}
 
-  absorbStop(mac_ctx);
-  absorb(mac_ctx, digestLen);
-  /* squeeze() */
-  if (mac_ctx->a) {
-    shuffle(mac_ctx);
-  }
-  for (i = 0; i < digestLen; i++) {
-    digest[i] = drip(mac_ctx);
-  }
+/** spritz_mac_withCtx()
+ * Message Authentication Code (MAC) function, Same as spritz_mac() but uses
+ * the caller's context `mac_ctx` instead of a local one (Stack saving).
+ * If SPRITZ_WIPE_TRACES is defined, `mac_ctx` will be wiped.
+ *
+ * Parameter mac_ctx:   The message authentication code (MAC) context (ctx) to work with.
+ * Parameter digest:    Message authentication code (MAC) digest output.
+ * Parameter digestlen: Length of the digest in bytes.
+ * Parameter msg:       The message to be authenticated.
+ * Parameter msglen:    Length of the message in bytes.
+ * Parameter key:       The secret key.
+ * Parameter keylen:    Length of the key in bytes.
+ */
+SPRITZ_API void
+spritz_mac_withCtx(spritz_ctx *mac_ctx,
+                   uint8_t *digest, uint8_t digestLen,
+                   const uint8_t *msg, uint16_t msgLen,
+                   const uint8_t *key, uint16_t keyLen)
+{
+  /* spritz_mac_setup() */
+  spritz_state_init(mac_ctx); /* spritz_hash_setup() */
+  spritz_absorb_bytes(mac_ctx, key, keyLen); /* spritz_hash_update() */
+  spritz_absorb_stop(mac_ctx);
+
+  /* spritz_mac_update() */
+  spritz_absorb_bytes(mac_ctx, msg, msgLen); /* spritz_hash_update() */
+
+  /* spritz_mac_final() */
+  spritz_squeeze_digest(mac_ctx, digest, digestLen); /* Same as spritz_hash_final() */
+
+  /* `mac_ctx` data will be replaced with 0x00 if SPRITZ_WIPE_TRACES is defined */
+#ifdef SPRITZ_WIPE_TRACES
+  spritz_state_memzero(mac_ctx);
+#endif
+  SPRITZ_WIPE_STACK();
 }
 
 /** spritz_mac()
@@ -653,36 +1105,64 @@ spritz_mac_final(spritz_ctx *mac_ctx,
  * Parameter key:       The secret key.
  * Parameter keylen:    Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac(uint8_t *digest, uint8_t digestLen,
            const uint8_t *msg, uint16_t msgLen,
            const uint8_t *key, uint16_t keyLen)
 {
-  uint8_t i;
   spritz_ctx mac_ctx;
 
-  /* spritz_mac_setup() */
-  spritz_state_init(&mac_ctx); /* spritz_hash_setup() */
-  absorbBytes(&mac_ctx, key, keyLen); /* spritz_hash_update() */
-  absorbStop(&mac_ctx);
+  spritz_mac_withCtx(&mac_ctx, digest, digestLen, msg, msgLen, key, keyLen);
+  SPRITZ_WIPE_STACK();
+}
 
-  /* spritz_mac_update() */
-  absorbBytes(&mac_ctx, msg, msgLen); /* spritz_hash_update() */
 
-  /* spritz_mac_final() */
-  /* Same as spritz_hash_final() */
-  absorbStop(&mac_ctx);
-  absorb(&mac_ctx, digestLen);
+/** spritz_xof_final()
+ * Finish the absorption of a hash or MAC context for an extendable output (XOF),
+ * Then output of any length can be read with spritz_xof_squeeze().
+ * Use it instead of spritz_hash_final() or spritz_mac_final(), The output is
+ * NOT the same as the fixed length digest, Or as the spritz_setup() and
+ * spritz_setup_withIV() keystream of the same key (and IV).
+ *
+ * Parameter ctx: The hash or MAC context (ctx).
+ */
+SPRITZ_API void
+spritz_xof_final(spritz_ctx *ctx)
+{
+  /* Domain separation: Three stops then a domain byte, The hash, MAC and setup
+   * functions never absorb more than two stops in a row, And stops alone do not
+   * change `s[]` (the shuffle resets `a`), So a byte must be absorbed after them.
+   */
+  spritz_absorb_stop(ctx);
+  spritz_absorb_stop(ctx);
+  spritz_absorb_stop(ctx);
+  spritz_absorb(ctx, SPRITZ_XOF_DOMAIN);
   /* squeeze() */
-  if (mac_ctx.a) {
-    shuffle(&mac_ctx);
-  }
-  for (i = 0; i < digestLen; i++) {
-    digest[i] = drip(&mac_ctx);
+  if (ctx->a) {
+    spritz_shuffle(ctx);
   }
+  SPRITZ_WIPE_STACK();
+}
 
-  /* `mac_ctx` data will be replaced with 0x00 if SPRITZ_WIPE_TRACES is defined */
-#ifdef SPRITZ_WIPE_TRACES
-  spritz_state_memzero(&mac_ctx);
-#endif
+/** spritz_xof_squeeze()
+ * Output the next `outlen` bytes of the extendable output (XOF),
+ * Can be called many times to get the output chunk by chunk.
+ * Usable only after calling spritz_xof_final().
+ *
+ * Parameter ctx:    The hash or MAC context (ctx).
+ * Parameter out:    The output.
+ * Parameter outlen: Length of the output in bytes.
+ */
+SPRITZ_API void
+spritz_xof_squeeze(spritz_ctx *ctx,
+                   uint8_t *out, uint16_t outLen)
+{
+  uint16_t i;
+
+  for (i = 0; i < outLen; i++) {
+    out[i] = spritz_drip_byte(ctx);
+  }
+  SPRITZ_WIPE_STACK();
 }
+
+#endif /* SpritzCipher.c */
@@ -78,11 +78,175 @@ extern "C" {
 # endif
 #endif
 
+/** SPRITZ_WIPE_TRACES_PARANOID_FAST
+ * Like SPRITZ_WIPE_TRACES_PARANOID (no spritz state left in the stack or the
+ * CPU registers) with less slowdown: Temporary variables stay in CPU registers
+ * instead of `spritz_ctx`. Before they return, The library functions that use
+ * the spritz state wipe SPRITZ_WIPE_STACK_SIZE bytes of the stack below their
+ * own frame (the frames of the internal functions they called), And the CPU
+ * registers they used (`zero_call_used_regs` attribute, GCC 11+ and Clang 15+).
+ * Their own frame is NOT wiped (the compiler may spill temporaries to it, e.g. at -O0).
+ * It is an error with AVR or other compilers that can not wipe the CPU registers.
+ * The equal time crush() is branchless in this mode, So it is optimized.
+ * The stack wipe is done in each call: Functions that do a lot of work in
+ * one call (e.g. spritz_crypt(), spritz_hash()) are faster than with
+ * SPRITZ_WIPE_TRACES_PARANOID, But a spritz_random8() call is slower (about 20% on x86-64).
+ *
+ * If defined, Then SPRITZ_WIPE_TRACES and SPRITZ_TIMING_SAFE_CRUSH
+ * will be defined automatically. Do not define it with SPRITZ_WIPE_TRACES_PARANOID.
+ */
+#if 0
+# define SPRITZ_WIPE_TRACES_PARANOID_FAST
+#endif
+
+#ifdef SPRITZ_WIPE_TRACES_PARANOID_FAST
+# ifdef SPRITZ_WIPE_TRACES_PARANOID
+#  error "Define SPRITZ_WIPE_TRACES_PARANOID or SPRITZ_WIPE_TRACES_PARANOID_FAST, Not both."
+# endif
+# ifndef SPRITZ_TIMING_SAFE_CRUSH
+#  define SPRITZ_TIMING_SAFE_CRUSH
+# endif
+# ifndef SPRITZ_WIPE_TRACES
+#  define SPRITZ_WIPE_TRACES
+# endif
+# ifndef SPRITZ_WIPE_STACK_SIZE
+#  define SPRITZ_WIPE_STACK_SIZE 128U
+# endif
+# if defined(__has_attribute) && !defined(__AVR__)
+#  if __has_attribute(zero_call_used_regs)
+#   define SPRITZ_WIPE_REGS __attribute__ ((zero_call_used_regs("used")))
+#  endif
+# endif
+# ifndef SPRITZ_WIPE_REGS
+#  error "SPRITZ_WIPE_TRACES_PARANOID_FAST: This compiler can not wipe the CPU registers, Use SPRITZ_WIPE_TRACES_PARANOID."
+# endif
+#else
+# define SPRITZ_WIPE_REGS
+#endif
+
+/** SPRITZ_HEADER_ONLY
+ * If defined, the library functions will be `static inline` in each file that
+ * includes SpritzCipher.h (It includes SpritzCipher.c), So the compiler can
+ * inline them into the caller's loops without link-time optimization (LTO).
+ * It can make the program code larger. The internal functions of the library
+ * are visible to that file too, Their names start with `spritz_` or `SPRITZ_`.
+ */
+#if 0
+# define SPRITZ_HEADER_ONLY
+#endif
+
+#if defined(SPRITZ_HEADER_ONLY) && defined(SPRITZ_WIPE_TRACES_PARANOID_FAST) \
+  && (defined(__GNUC__) || defined(__clang__))
+/* Not inlined, The CPU registers are wiped only when a function returns */
+# define SPRITZ_API static __attribute__ ((noinline, unused)) SPRITZ_WIPE_REGS
+#elif defined(SPRITZ_HEADER_ONLY)
+# define SPRITZ_API static inline SPRITZ_WIPE_REGS
+#else
+# define SPRITZ_API SPRITZ_WIPE_REGS
+#endif
+
+/** SPRITZ_COOPERATIVE_SHUFFLE
+ * If defined, spritz_setup() and spritz_setup_withiv() will not shuffle
+ * the state at their end, The shuffle can be done step by step with spritz_step()
+ * to bound the time of each call (e.g. in real-time loops).
+ * The first output does what is left of it, The output does not change.
+ * It makes `spritz_ctx` 2 bytes larger.
+ */
+#if 0
+# define SPRITZ_COOPERATIVE_SHUFFLE
+#endif
+
+/** SPRITZ_CTX_ALIGNED
+ * If defined, `spritz_ctx` will be aligned (and padded) to a cache line
+ * of SPRITZ_CTX_ALIGNMENT bytes, So contexts placed next to each other
+ * (e.g. an array of sessions contexts) do not share a cache line.
+ * Useful only in multi-core systems, it makes `spritz_ctx` larger. GCC and Clang only.
+ * Not for small RAM microcontrollers: A larger SPRITZ_CTX_ALIGNMENT (e.g. 256)
+ * makes `spritz_ctx` up to twice larger, Also the local one in spritz_hash() and spritz_mac().
+ */
+#if 0
+# define SPRITZ_CTX_ALIGNED
+#endif
+
+#ifdef SPRITZ_CTX_ALIGNED
+# ifndef SPRITZ_CTX_ALIGNMENT
+#  define SPRITZ_CTX_ALIGNMENT 64
+# endif
+# if defined(__GNUC__) || defined(__clang__)
+#  define SPRITZ_CTX_ATTRIBUTES __attribute__ ((aligned(SPRITZ_CTX_ALIGNMENT)))
+# else
+#  warning "SPRITZ_CTX_ALIGNED warning: Not GCC or Clang, spritz_ctx will not be aligned."
+# endif
+#endif
+#ifndef SPRITZ_CTX_ATTRIBUTES
+# define SPRITZ_CTX_ATTRIBUTES
+#endif
+
 /** SPRITZ_N
- * Present the value of N in this spritz implementation,
- * DO NOT change SPRITZ_N value.
+ * Present the value of N in this spritz implementation (Size of the state array),
+ * It can be 16, 32, 64, 128 or 256 (the default).
+ * A smaller N saves RAM, But it is slower (more outputs for a byte of keystream)
+ * and has a lower security margin. The Spritz paper test vectors are for N=256 only.
+ * It must be the same in every file that includes SpritzCipher.h and in SpritzCipher.c,
+ * So change it here or in the global build flags, Not with a `#define` in a sketch.
  */
-#define SPRITZ_N 256U
+#ifndef SPRITZ_N
+# define SPRITZ_N 256U
+#endif
+
+/* With SPRITZ_N other than 256, The functions that use `spritz_ctx` get
+ * the suffix `_n<N>` in their link names (e.g. `spritz_setup_n16`),
+ * So a file compiled with another SPRITZ_N than SpritzCipher.c references
+ * functions that do not exist and fails to link (even with `--gc-sections` or LTO).
+ */
+#if SPRITZ_N == 256U
+/* No suffix, The names are not changed */
+#elif SPRITZ_N == 128U
+# define SPRITZ_N_NAME(name) name ## _n128
+#elif SPRITZ_N == 64U
+# define SPRITZ_N_NAME(name) name ## _n64
+#elif SPRITZ_N == 32U
+# define SPRITZ_N_NAME(name) name ## _n32
+#elif SPRITZ_N == 16U
+# define SPRITZ_N_NAME(name) name ## _n16
+#else
+# error "SPRITZ_N must be 16, 32, 64, 128 or 256."
+#endif
+
+#ifdef SPRITZ_N_NAME
+# define spritz_state_memzero      SPRITZ_N_NAME(spritz_state_memzero)
+# define spritz_setup              SPRITZ_N_NAME(spritz_setup)
+# define spritz_setup_withIV       SPRITZ_N_NAME(spritz_setup_withIV)
+# define spritz_step               SPRITZ_N_NAME(spritz_step)
+# define spritz_is_ready           SPRITZ_N_NAME(spritz_is_ready)
+# define spritz_random8            SPRITZ_N_NAME(spritz_random8)
+# define spritz_random32           SPRITZ_N_NAME(spritz_random32)
+# define spritz_random32_uniform   SPRITZ_N_NAME(spritz_random32_uniform)
+# define spritz_add_entropy        SPRITZ_N_NAME(spritz_add_entropy)
+# define spritz_entropy_ring_drain SPRITZ_N_NAME(spritz_entropy_ring_drain)
+# define spritz_crypt              SPRITZ_N_NAME(spritz_crypt)
+# define spritz_crypt_inplace      SPRITZ_N_NAME(spritz_crypt_inplace)
+# define spritz_hash_setup         SPRITZ_N_NAME(spritz_hash_setup)
+# define spritz_hash_update        SPRITZ_N_NAME(spritz_hash_update)
+# define spritz_hash_final         SPRITZ_N_NAME(spritz_hash_final)
+# define spritz_hash_withCtx       SPRITZ_N_NAME(spritz_hash_withCtx)
+# define spritz_hash               SPRITZ_N_NAME(spritz_hash)
+# define spritz_mac_setup          SPRITZ_N_NAME(spritz_mac_setup)
+# define spritz_mac_update         SPRITZ_N_NAME(spritz_mac_update)
+# define spritz_mac_final          SPRITZ_N_NAME(spritz_mac_final)
+# define spritz_mac_withCtx        SPRITZ_N_NAME(spritz_mac_withCtx)
+# define spritz_mac                SPRITZ_N_NAME(spritz_mac)
+# define spritz_xof_final          SPRITZ_N_NAME(spritz_xof_final)
+# define spritz_xof_squeeze        SPRITZ_N_NAME(spritz_xof_squeeze)
+#endif
+
+/** SPRITZ_ENTROPY_RING_SIZE
+ * Size in bytes of the buffer in `spritz_entropy_ring`,
+ * It must be a power of 2 and not bigger than 128.
+ */
+#ifndef SPRITZ_ENTROPY_RING_SIZE
+# define SPRITZ_ENTROPY_RING_SIZE 32U
+#endif
 
 /* `Semantic Versioning` of this library */
 #define SPRITZ_LIBRARY_VERSION_STRING "1.2.0"
@@ -104,7 +268,22 @@ typedef struct
    */
   uint8_t tmp1, tmp2;
 #endif
-} spritz_ctx;
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+  /* Progress of the shuffle in progress, 0 if there is no one */
+  uint16_t shuffle_pos;
+#endif
+} SPRITZ_CTX_ATTRIBUTES spritz_ctx;
+
+/** spritz_entropy_ring
+ * Single-producer single-consumer lock-free ring of entropy bytes,
+ * An interrupt handler pushes bytes and the main loop drains them into a `spritz_ctx`.
+ */
+typedef struct
+{
+  volatile uint8_t buf[SPRITZ_ENTROPY_RING_SIZE];
+  volatile uint8_t head; /* Written only by the producer (e.g. the ISR) */
+  volatile uint8_t tail; /* Written only by the consumer (e.g. the main loop) */
+} spritz_entropy_ring;
 
 /** spritz_compare()
  * Timing-safe equality comparison for `data_a` and `data_b`.
@@ -118,7 +297,7 @@ typedef struct
  *         Zero (0x00) if `data_a` equals `data_b` OR if `len` is zero,
  *         Non-zero value if they are NOT equal.
  */
-uint8_t
+SPRITZ_API uint8_t
 spritz_compare(const uint8_t *data_a, const uint8_t *data_b, uint16_t len);
 
 /** spritz_memzero()
@@ -127,7 +306,7 @@ spritz_compare(const uint8_t *data_a, const uint8_t *data_b, uint16_t len);
  * Parameter buf: Data to replace it with zeros (0x00).
  * Parameter len: Length of array in bytes.
  */
-void
+SPRITZ_API void
 spritz_memzero(uint8_t *buf, uint16_t len);
 
 /** spritz_state_memzero()
@@ -135,7 +314,7 @@ spritz_memzero(uint8_t *buf, uint16_t len);
  *
  * Parameter ctx: The context.
  */
-void
+SPRITZ_API void
 spritz_state_memzero(spritz_ctx *ctx);
 
 
@@ -146,7 +325,7 @@ spritz_state_memzero(spritz_ctx *ctx);
  * Parameter key:    The key.
  * Parameter keylen: Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_setup(spritz_ctx *ctx,
              const uint8_t *key, uint8_t keyLen);
 
@@ -159,11 +338,41 @@ spritz_setup(spritz_ctx *ctx,
  * Parameter nonce:    The nonce (salt).
  * Parameter noncelen: Length of the nonce in bytes.
  */
-void
+SPRITZ_API void
 spritz_setup_withIV(spritz_ctx *ctx,
                     const uint8_t *key, uint8_t keyLen,
                     const uint8_t *nonce, uint8_t nonceLen);
 
+#ifdef SPRITZ_COOPERATIVE_SHUFFLE
+/** spritz_step()
+ * Do up to `max_updates` steps of the shuffle pending from spritz_setup() or
+ * spritz_setup_withiv(), To split it over many calls (e.g. from a real-time loop).
+ * A shuffle is 6*SPRITZ_N steps (1536 for N=256), The output is the same as without spritz_step().
+ * The shuffle pending from spritz_add_entropy() is not done by spritz_step(),
+ * It is done by the next output like without SPRITZ_COOPERATIVE_SHUFFLE.
+ * Not for hash and MAC contexts.
+ * Available only if SPRITZ_COOPERATIVE_SHUFFLE is defined.
+ *
+ * Parameter ctx:         The context.
+ * Parameter max_updates: Maximum number of steps (update() calls) to do.
+ *
+ * Return: Non-zero value if the setup shuffle is done, Else zero (0x00).
+ */
+SPRITZ_API uint8_t
+spritz_step(spritz_ctx *ctx, uint16_t max_updates);
+
+/** spritz_is_ready()
+ * Check if the shuffle pending from spritz_setup() or spritz_setup_withiv() is done.
+ * Available only if SPRITZ_COOPERATIVE_SHUFFLE is defined.
+ *
+ * Parameter ctx: The context.
+ *
+ * Return: Non-zero value if the setup shuffle is done, Else zero (0x00).
+ */
+SPRITZ_API uint8_t
+spritz_is_ready(const spritz_ctx *ctx);
+#endif /* SPRITZ_COOPERATIVE_SHUFFLE */
+
 /** spritz_random8()
  * Generates a random byte from the spritz state `spritz_ctx`.
  * Usable only after calling spritz_setup() or spritz_setup_withiv().
@@ -172,7 +381,7 @@ spritz_setup_withIV(spritz_ctx *ctx,
  *
  * Return: Byte of keystream.
  */
-uint8_t
+SPRITZ_API uint8_t
 spritz_random8(spritz_ctx *ctx);
 
 /** spritz_random32()
@@ -183,7 +392,7 @@ spritz_random8(spritz_ctx *ctx);
  *
  * Return: 32-bit (4 bytes) of keystream.
  */
-uint32_t
+SPRITZ_API uint32_t
 spritz_random32(spritz_ctx *ctx);
 
 /** spritz_random32_uniform()
@@ -203,7 +412,7 @@ spritz_random32(spritz_ctx *ctx);
  *
  * Return: Random number less than upper_bound, 0 if upper_bound<2.
  */
-uint32_t
+SPRITZ_API uint32_t
 spritz_random32_uniform(spritz_ctx *ctx, uint32_t upper_bound);
 
 /** spritz_add_entropy()
@@ -214,12 +423,49 @@ spritz_random32_uniform(spritz_ctx *ctx, uint32_t upper_bound);
  * Parameter entropy: The entropy array.
  * Parameter len:     Length of the entropy array in bytes.
  */
-void
+SPRITZ_API void
 spritz_add_entropy(spritz_ctx *ctx,
                    const uint8_t *entropy, uint16_t len);
 
+/** spritz_entropy_ring_init()
+ * Setup an empty entropy ring `spritz_entropy_ring`.
+ *
+ * Parameter ring: The entropy ring.
+ */
+SPRITZ_API void
+spritz_entropy_ring_init(spritz_entropy_ring *ring);
+
+/** spritz_entropy_ring_push()
+ * Add an entropy byte to the ring in constant time,
+ * Can be called from an interrupt handler (ISR) or a signal handler.
+ * Only one producer can push to the ring.
+ *
+ * Parameter ring:  The entropy ring.
+ * Parameter octet: The entropy byte.
+ *
+ * Return: Zero (0x00) if the byte is added, Non-zero value if the ring is full.
+ */
+SPRITZ_API uint8_t
+spritz_entropy_ring_push(spritz_entropy_ring *ring, uint8_t octet);
+
+/** spritz_entropy_ring_drain()
+ * Add the entropy in the ring to the spritz state `spritz_ctx`
+ * like spritz_add_entropy(), And empty the ring.
+ * Only one consumer can drain the ring, NOT from an interrupt handler.
+ * Usable only after calling spritz_setup() or spritz_setup_withiv().
+ *
+ * Parameter ctx:  The context.
+ * Parameter ring: The entropy ring.
+ *
+ * Return: Number of the added entropy bytes.
+ */
+SPRITZ_API uint16_t
+spritz_entropy_ring_drain(spritz_ctx *ctx, spritz_entropy_ring *ring);
+
 /** spritz_crypt()
  * Encrypt or decrypt data chunk by XOR-ing it with the spritz keystream.
+ * The keystream continues from a call to the next one, So a message held
+ * in many buffers can be processed chunk by chunk, `data` can be `dataout`.
  * Usable only after calling spritz_setup() or spritz_setup_withiv().
  *
  * Parameter ctx:     The context.
@@ -227,7 +473,7 @@ spritz_add_entropy(spritz_ctx *ctx,
  * Parameter datalen: Length of the data in bytes.
  * Parameter dataout: The output.
  */
-void
+SPRITZ_API void
 spritz_crypt(spritz_ctx *ctx,
              const uint8_t *data, uint16_t dataLen,
              uint8_t *dataOut);
@@ -241,7 +487,7 @@ spritz_crypt(spritz_ctx *ctx,
  * Parameter data:    The data to encrypt or decrypt, also the output.
  * Parameter datalen: Length of the data in bytes.
  */
-void
+SPRITZ_API void
 spritz_crypt_inplace(spritz_ctx *ctx,
                      uint8_t *data, uint16_t dataLen);
 
@@ -251,17 +497,18 @@ spritz_crypt_inplace(spritz_ctx *ctx,
  *
  * Parameter hash_ctx: The hash context (ctx).
  */
-void
+SPRITZ_API void
 spritz_hash_setup(spritz_ctx *hash_ctx);
 
 /** spritz_hash_update()
  * Add a message/data chunk `data` to hash.
+ * Hashing chunk by chunk gives the same digest as hashing all the data at once.
  *
  * Parameter hash_ctx: The hash context (ctx).
  * Parameter data:     The data chunk to hash.
  * Parameter datalen:  Length of the data in bytes.
  */
-void
+SPRITZ_API void
 spritz_hash_update(spritz_ctx *hash_ctx,
                    const uint8_t *data, uint16_t dataLen);
 
@@ -272,10 +519,26 @@ spritz_hash_update(spritz_ctx *hash_ctx,
  * Parameter digest:    The digest (hash) output.
  * Parameter digestlen: Length of the digest in bytes.
  */
-void
+SPRITZ_API void
 spritz_hash_final(spritz_ctx *hash_ctx,
                   uint8_t *digest, uint8_t digestLen);
 
+/** spritz_hash_withCtx()
+ * Cryptographic hash function, Same as spritz_hash() but uses the
+ * caller's context `hash_ctx` instead of a local one (Stack saving).
+ * If SPRITZ_WIPE_TRACES is defined, `hash_ctx` will be wiped.
+ *
+ * Parameter hash_ctx:  The hash context (ctx) to work with.
+ * Parameter digest:    The digest (hash) output.
+ * Parameter digestlen: Length of the digest in bytes.
+ * Parameter data:      The data to hash.
+ * Parameter datalen:   Length of the data in bytes.
+ */
+SPRITZ_API void
+spritz_hash_withCtx(spritz_ctx *hash_ctx,
+                    uint8_t *digest, uint8_t digestLen,
+                    const uint8_t *data, uint16_t dataLen);
+
 /** spritz_hash()
  * Cryptographic hash function.
  *
@@ -284,7 +547,7 @@ spritz_hash_final(spritz_ctx *hash_ctx,
  * Parameter data:      The data to hash.
  * Parameter datalen:   Length of the data in bytes.
  */
-void
+SPRITZ_API void
 spritz_hash(uint8_t *digest, uint8_t digestLen,
             const uint8_t *data, uint16_t dataLen);
 
@@ -296,18 +559,19 @@ spritz_hash(uint8_t *digest, uint8_t digestLen,
  * Parameter key:     The secret key.
  * Parameter keylen:  Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_setup(spritz_ctx *mac_ctx,
                  const uint8_t *key, uint16_t keyLen);
 
 /** spritz_mac_update()
  * Add a message/data chunk to message authentication code (MAC).
+ * Adding chunk by chunk gives the same digest as adding all the message at once.
  *
  * Parameter hash_ctx: The hash context (ctx).
  * Parameter msg:      The message chunk to be authenticated.
  * Parameter msglen:   Length of the message in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_update(spritz_ctx *mac_ctx,
                   const uint8_t *msg, uint16_t msgLen);
 
@@ -318,10 +582,29 @@ spritz_mac_update(spritz_ctx *mac_ctx,
  * Parameter digest:    Message authentication code (MAC) digest output.
  * Parameter digestlen: Length of the digest in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac_final(spritz_ctx *mac_ctx,
                  uint8_t *digest, uint8_t digestLen);
 
+/** spritz_mac_withCtx()
+ * Message Authentication Code (MAC) function, Same as spritz_mac() but uses
+ * the caller's context `mac_ctx` instead of a local one (Stack saving).
+ * If SPRITZ_WIPE_TRACES is defined, `mac_ctx` will be wiped.
+ *
+ * Parameter mac_ctx:   The message authentication code (MAC) context (ctx) to work with.
+ * Parameter digest:    Message authentication code (MAC) digest output.
+ * Parameter digestlen: Length of the digest in bytes.
+ * Parameter msg:       The message to be authenticated.
+ * Parameter msglen:    Length of the message in bytes.
+ * Parameter key:       The secret key.
+ * Parameter keylen:    Length of the key in bytes.
+ */
+SPRITZ_API void
+spritz_mac_withCtx(spritz_ctx *mac_ctx,
+                   uint8_t *digest, uint8_t digestLen,
+                   const uint8_t *msg, uint16_t msgLen,
+                   const uint8_t *key, uint16_t keyLen);
+
 /** spritz_mac()
  * Message Authentication Code (MAC) function.
  *
@@ -332,12 +615,43 @@ spritz_mac_final(spritz_ctx *mac_ctx,
  * Parameter key:       The secret key.
  * Parameter keylen:    Length of the key in bytes.
  */
-void
+SPRITZ_API void
 spritz_mac(uint8_t *digest, uint8_t digestLen,
            const uint8_t *msg, uint16_t msgLen,
            const uint8_t *key, uint16_t keyLen);
 
 
+/** spritz_xof_final()
+ * Finish the absorption of a hash or MAC context for an extendable output (XOF),
+ * Then output of any length can be read with spritz_xof_squeeze().
+ * Use it instead of spritz_hash_final() or spritz_mac_final(), The output is
+ * NOT the same as the fixed length digest, Or as the spritz_setup() and
+ * spritz_setup_withIV() keystream of the same key (and IV).
+ *
+ * Parameter ctx: The hash or MAC context (ctx).
+ */
+SPRITZ_API void
+spritz_xof_final(spritz_ctx *ctx);
+
+/** spritz_xof_squeeze()
+ * Output the next `outlen` bytes of the extendable output (XOF),
+ * Can be called many times to get the output chunk by chunk.
+ * Usable only after calling spritz_xof_final().
+ *
+ * Parameter ctx:    The hash or MAC context (ctx).
+ * Parameter out:    The output.
+ * Parameter outlen: Length of the output in bytes.
+ */
+SPRITZ_API void
+spritz_xof_squeeze(spritz_ctx *ctx,
+                   uint8_t *out, uint16_t outLen);
+
+
+#ifdef SPRITZ_HEADER_ONLY
+# include "SpritzCipher.c"
+#endif /* SPRITZ_HEADER_ONLY */
+
+
 #ifdef __cplusplus
 }
 #endif